@@ -0,0 +1,123 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "allocation-counter.hpp"
+#include "processing.hpp"
+#include "yolo-nas.hpp"
+
+// Checks that steady-state frames make no heap allocations. The first
+// frames may grow the reused buffers, every frame after that must allocate
+// nothing. Covers the host postprocessing on a synthetic [8400 x 80] output
+// and, given a model, detect() and submit()/retrieve() end to end. Exits
+// with 1 when a steady-state frame allocated.
+//
+// usage: alloc_bench [model.xml]
+
+static const int warmupFrames = 3;
+static const int frames = 20;
+
+// Runs frame() repeatedly and reports the allocations after warm-up
+static bool steadyState(const std::string& name, const std::function<void()>& frame)
+{
+    for (int i = 0; i < warmupFrames; i++)
+        frame();
+
+    size_t count = 0;
+    for (int i = 0; i < frames; i++) {
+        CountAllocations counting(count);
+        frame();
+    }
+    std::cout << name << ":\t" << count << " allocations in " << frames << " frames" << (count == 0 ? "" : " FAIL") << std::endl;
+    return count == 0;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t anchors = 8400;
+    const size_t classes = 80;
+
+    // a crowded frame: a fifth of the anchors see an object
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::vector<float> bboxes(anchors * 4), scores(anchors * classes), best(anchors * 2);
+    for (size_t i = 0; i < anchors; i++) {
+        float x = uniform(random) * 600.0f, y = uniform(random) * 600.0f;
+        bboxes[i * 4] = x;
+        bboxes[i * 4 + 1] = y;
+        bboxes[i * 4 + 2] = x + 40.0f;
+        bboxes[i * 4 + 3] = y + 40.0f;
+    }
+    for (auto& score : scores)
+        score = uniform(random) * 0.05f;
+    for (size_t i = 0; i < anchors; i += 5)
+        scores[i * classes + random() % classes] = 0.3f + 0.6f * uniform(random);
+    for (size_t i = 0; i < anchors; i++) {
+        const float* row = scores.data() + i * classes;
+        size_t top = std::max_element(row, row + classes) - row;
+        best[i * 2] = row[top];
+        best[i * 2 + 1] = static_cast<float>(top);
+    }
+
+    bool ok = true;
+    std::vector<Box> boxes;
+
+    PPYoloEPostPredictionCallback single(0.25f, 0.45f, 1000, 300, false);
+    ok &= steadyState("forward single label", [&]() { single.forward(bboxes.data(), scores.data(), anchors, classes, &boxes, 1); });
+
+    PPYoloEPostPredictionCallback multi(0.25f, 0.45f, 1000, 300, true, NmsMethod::Offset);
+    ok &= steadyState("forward multi label, offset", [&]() { multi.forward(bboxes.data(), scores.data(), anchors, classes, &boxes, 1); });
+
+    ok &= steadyState("forwardBest", [&]() { single.forwardBest(bboxes.data(), best.data(), anchors, &boxes, 1); });
+
+    if (argc > 1) {
+        YoloNASConfig config;
+        YoloNAS model(argv[1], config);
+        cv::Mat frame(720, 1280, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        cv::Mat result;
+
+        ok &= steadyState("detect", [&]() { model.detect(frame, boxes); });
+
+        // one frame in, the oldest out, with every request busy
+        while (model.pending() < model.numRequests())
+            model.submit(frame);
+        ok &= steadyState("submit/retrieve", [&]() {
+            model.retrieve(result, boxes);
+            model.submit(frame);
+        });
+        while (model.retrieve(result, boxes)) {
+        }
+    }
+
+    return ok ? 0 : 1;
+}
\ No newline at end of file
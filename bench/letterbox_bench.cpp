@@ -0,0 +1,92 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "bench.hpp"
+#include "cpu-features.hpp"
+#include "letterbox.hpp"
+
+// Compares letterboxing a frame into a [640 x 640] input at 720p, 1080p and 4K:
+// the original copyMakeBorder + resize, cv::resize into the canvas, and the
+// fused letterboxNearest() kernel at every SIMD level the CPU supports.
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+    const int size = 640;
+    const std::vector<std::pair<std::string, cv::Size>> resolutions = {
+        { "720p", cv::Size(1280, 720) },
+        { "1080p", cv::Size(1920, 1080) },
+        { "4K", cv::Size(3840, 2160) },
+    };
+
+    std::cout << "best kernel: " << simdLevelName(supportedSimdLevel()) << ", " << iterations << " iterations" << std::endl;
+
+    for (const auto& resolution : resolutions) {
+        cv::Mat frame(resolution.second, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+        int maxSize = std::max(frame.cols, frame.rows);
+        int width = cvRound(frame.cols * (float)size / (float)maxSize);
+        int height = cvRound(frame.rows * (float)size / (float)maxSize);
+        cv::Mat canvas(size, size, CV_8UC3);
+
+        double padResize = averageMs([&]() {
+            cv::Mat padded;
+            cv::copyMakeBorder(frame, padded, 0, maxSize - frame.rows, 0, maxSize - frame.cols, cv::BORDER_CONSTANT);
+            cv::resize(padded, canvas, canvas.size(), 0, 0, cv::INTER_NEAREST);
+        }, iterations);
+
+        double resizeInto = averageMs([&]() {
+            cv::Mat content = canvas(cv::Rect(0, 0, width, height));
+            cv::resize(frame, content, content.size(), 0, 0, cv::INTER_NEAREST);
+            canvas(cv::Rect(0, height, size, size - height)).setTo(cv::Scalar::all(0));
+        }, iterations);
+
+        std::cout << resolution.first << ":\tcopyMakeBorder+resize " << padResize << "ms"
+                  << "\tresize " << resizeInto << "ms";
+
+        for (int level = 0; level <= static_cast<int>(supportedSimdLevel()); level++) {
+            setSimdLevel(static_cast<SimdLevel>(level));
+            double fused = averageMs([&]() {
+                letterboxNearest(frame.data, frame.cols, frame.rows, frame.step, canvas.data, canvas.cols, canvas.rows, canvas.step, width, height);
+            }, iterations);
+
+            double fusedSwap = averageMs([&]() {
+                letterboxNearest(frame.data, frame.cols, frame.rows, frame.step, canvas.data, canvas.cols, canvas.rows, canvas.step, width, height, true);
+            }, iterations);
+
+            std::cout << "\tfused " << letterboxKernel() << " " << fused << "ms"
+                      << " (swapRB " << fusedSwap << "ms)";
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
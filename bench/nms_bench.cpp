@@ -0,0 +1,122 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "cpu-features.hpp"
+#include "nms.hpp"
+#include "processing.hpp"
+
+// Compares nonMaxSuppression(), at every SIMD level the CPU supports, with
+// the all-pairs loop it replaced on crowded scenes of 1000 to 3000
+// candidates: many objects, each detected several times with jitter, like a
+// packed crowd or parking lot.
+
+// The previous PPYoloEPostPredictionCallback::performNMS
+static std::vector<size_t> allPairsNms(const std::vector<Box>& boxes, float iou_threshold)
+{
+    auto area = [](const Box& box) { return (box.x2 - box.x1) * (box.y2 - box.y1); };
+    auto intersection = [](const Box& a, const Box& b) {
+        float x1 = std::max(a.x1, b.x1);
+        float y1 = std::max(a.y1, b.y1);
+        float x2 = std::min(a.x2, b.x2);
+        float y2 = std::min(a.y2, b.y2);
+        return std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+    };
+
+    std::vector<size_t> keep;
+    std::vector<bool> suppressed(boxes.size(), false);
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (suppressed[i])
+            continue;
+        keep.push_back(i);
+        for (size_t j = i + 1; j < boxes.size(); j++) {
+            if (suppressed[j])
+                continue;
+            float overlap = intersection(boxes[i], boxes[j]);
+            float iou = overlap / (area(boxes[i]) + area(boxes[j]) - overlap);
+            if (iou > iou_threshold && static_cast<size_t>(boxes[i].class_id) == static_cast<size_t>(boxes[j].class_id))
+                suppressed[j] = true;
+        }
+    }
+    return keep;
+}
+
+// Objects whose top-left corner lies in [0, extent), e.g. a tiled 4K frame
+// at 5000
+static std::vector<Box> crowdedScene(std::mt19937& random, int objects, int classes, int candidates, float extent = 600.0f)
+{
+    std::uniform_real_distribution<float> position(0.0f, extent);
+    std::uniform_real_distribution<float> size(15.0f, 80.0f);
+    std::normal_distribution<float> jitter(0.0f, 4.0f);
+    std::uniform_real_distribution<float> confidence(0.25f, 0.95f);
+
+    std::vector<Box> scene;
+    for (int o = 0; o < objects; o++) {
+        float x = position(random), y = position(random), w = size(random), h = size(random);
+        float class_id = static_cast<float>(random() % classes);
+        for (int c = 0; c < candidates / objects; c++)
+            scene.push_back({ x + jitter(random), y + jitter(random), x + w + jitter(random), y + h + jitter(random), confidence(random), class_id });
+    }
+    std::sort(scene.begin(), scene.end(), [](const Box& a, const Box& b) { return a.confidence > b.confidence; });
+    return scene;
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+    const float iouThreshold = 0.45f;
+    std::mt19937 random(7);
+
+    const std::vector<std::pair<std::string, std::vector<Box>>> scenes = {
+        { "200 objects, 1 class", crowdedScene(random, 200, 1, 1000) },
+        { "200 objects, 4 classes", crowdedScene(random, 200, 4, 1000) },
+        { "100 objects, 80 classes", crowdedScene(random, 100, 80, 1000) },
+        // large coordinates shifted by 80 classes, where a float sort key
+        // would round off the fraction of a pixel
+        { "200 objects, 80 classes, 5000px", crowdedScene(random, 200, 80, 3000, 5000.0f) },
+    };
+
+    std::cout << "best kernel: " << simdLevelName(supportedSimdLevel()) << ", " << iterations << " iterations" << std::endl;
+    for (const auto& scene : scenes) {
+        std::vector<size_t> expected, sweep, offset;
+        double allPairs = averageMs([&]() { expected = allPairsNms(scene.second, iouThreshold); }, iterations);
+        std::cout << scene.first << ":\tall pairs " << allPairs << "ms\t" << expected.size() << " kept" << std::endl;
+
+        for (int level = 0; level <= static_cast<int>(supportedSimdLevel()); level++) {
+            setSimdLevel(static_cast<SimdLevel>(level));
+            double sweepMs = averageMs([&]() { sweep = nonMaxSuppression(scene.second, iouThreshold, NmsMethod::Sweep); }, iterations);
+            double offsetMs = averageMs([&]() { offset = nonMaxSuppression(scene.second, iouThreshold, NmsMethod::Offset); }, iterations);
+            std::cout << "\t" << nmsKernel() << "\tsweep " << sweepMs << "ms" << (sweep == expected ? "" : " MISMATCH")
+                      << "\toffset " << offsetMs << "ms" << (offset == expected ? "" : " MISMATCH") << std::endl;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
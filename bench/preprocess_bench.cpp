@@ -0,0 +1,171 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "preprocess.hpp"
+#include "yolo-nas.hpp"
+
+// Runs every preprocessing backend over a folder of images and reports the
+// preprocessing and detection time per image, and how far the detections
+// drift from the reference backend.
+//
+// usage: preprocess_bench <model.xml> <image-dir> [reference-backend]
+
+static float iou(const Box& a, const Box& b)
+{
+    float width = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    float height = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    if (width <= 0.0f || height <= 0.0f)
+        return 0.0f;
+    float intersection = width * height;
+    float areas = (a.x2 - a.x1) * (a.y2 - a.y1) + (b.x2 - b.x1) * (b.y2 - b.y1);
+    return intersection / (areas - intersection);
+}
+
+struct Drift
+{
+    size_t matched = 0;
+    size_t missed = 0;
+    size_t extra = 0;
+    double iouSum = 0.0;
+};
+
+// Greedy one-to-one matching of same-class boxes with IoU >= 0.5
+static void compare(const std::vector<Box>& reference, const std::vector<Box>& boxes, Drift& drift)
+{
+    std::vector<bool> used(boxes.size(), false);
+    for (const auto& expected : reference) {
+        size_t best = boxes.size();
+        float bestIou = 0.5f;
+        for (size_t i = 0; i < boxes.size(); i++) {
+            if (used[i] || boxes[i].class_id != expected.class_id)
+                continue;
+            float overlap = iou(expected, boxes[i]);
+            if (overlap >= bestIou) {
+                best = i;
+                bestIou = overlap;
+            }
+        }
+
+        if (best == boxes.size()) {
+            drift.missed++;
+            continue;
+        }
+        used[best] = true;
+        drift.matched++;
+        drift.iouSum += bestIou;
+    }
+    drift.extra += std::count(used.begin(), used.end(), false);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "usage: preprocess_bench <model.xml> <image-dir> [reference-backend]" << std::endl;
+        return 1;
+    }
+    std::string modelPath = argv[1];
+    std::string reference = argc > 3 ? argv[3] : "opencv-linear";
+
+    std::vector<cv::Mat> images;
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(argv[2])) {
+        if (entry.is_regular_file())
+            paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const auto& path : paths) {
+        cv::Mat img = cv::imread(path);
+        if (!img.empty())
+            images.push_back(img);
+    }
+    if (images.empty()) {
+        std::cerr << "no images found in " << argv[2] << std::endl;
+        return 1;
+    }
+
+    // the reference goes first so the others can be compared against it
+    std::vector<std::string> backends = preprocessorNames();
+    backends.erase(std::remove(backends.begin(), backends.end(), reference), backends.end());
+    backends.insert(backends.begin(), reference);
+
+    std::vector<std::vector<Box>> referenceBoxes;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "backend\t\tpreprocess ms\tdetect ms\tmatched\tmissed\textra\tmean IoU" << std::endl;
+
+    for (const auto& backend : backends) {
+        YoloNASConfig config;
+        config.preprocess = backend;
+        YoloNAS model(modelPath, config);
+
+        double preprocessMs = 0.0;
+        double detectMs = 0.0;
+        Drift drift;
+        std::vector<std::vector<Box>> results;
+
+        // warm-up
+        model.detect(images[0]);
+
+        cv::Mat canvas(config.imgSize[1], config.imgSize[0], CV_8UC3);
+        for (const auto& img : images) {
+            if (backend != "ppp") {
+                Ratios ratios;
+                auto begin = std::chrono::steady_clock::now();
+                model.letterbox(img, canvas, ratios);
+                auto end = std::chrono::steady_clock::now();
+                preprocessMs += std::chrono::duration<double, std::milli>(end - begin).count();
+            }
+
+            auto begin = std::chrono::steady_clock::now();
+            results.push_back(model.detect(img));
+            auto end = std::chrono::steady_clock::now();
+            detectMs += std::chrono::duration<double, std::milli>(end - begin).count();
+        }
+
+        if (referenceBoxes.empty())
+            referenceBoxes = results;
+        for (size_t i = 0; i < results.size(); i++)
+            compare(referenceBoxes[i], results[i], drift);
+
+        std::cout << std::left << std::setw(16) << backend;
+        if (backend == "ppp")
+            std::cout << "in graph\t";
+        else
+            std::cout << preprocessMs / images.size() << "\t\t";
+        std::cout << detectMs / images.size() << "\t\t"
+                  << drift.matched << "\t" << drift.missed << "\t" << drift.extra << "\t"
+                  << (drift.matched ? drift.iouSum / drift.matched : 0.0) << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "cpu-features.hpp"
+#include "score-scan.hpp"
+
+// Compares the score scans, at every SIMD level the CPU supports, against the
+// loops they replaced on a [8400 x 80] score tensor shaped like real YOLO-NAS
+// output: almost every score near zero, a few hundred anchors with one
+// confident class.
+//
+// The old multi-label loop indexed anchors with the anchor count and read
+// past the tensor, so the baseline here is the same loop with the class
+// count as the stride.
+
+static void loopMaxScores(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    for (size_t i = 0; i < anchors; i++) {
+        const float* score_begin = scores + i * classes;
+        const float* max_el = std::max_element(score_begin, score_begin + classes);
+        if (*max_el >= threshold)
+            out.push_back({ *max_el, static_cast<uint32_t>(i), static_cast<uint32_t>(max_el - score_begin) });
+    }
+}
+
+static void loopAllScores(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    for (size_t i = 0; i < anchors; i++) {
+        for (size_t j = 0; j < classes; j++) {
+            if (scores[i * classes + j] > threshold)
+                out.push_back({ scores[i * classes + j], static_cast<uint32_t>(i), static_cast<uint32_t>(j) });
+        }
+    }
+}
+
+static bool same(const std::vector<Candidate>& a, const std::vector<Candidate>& b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Candidate& x, const Candidate& y) {
+        return x.score == y.score && x.anchor == y.anchor && x.class_id == y.class_id;
+    });
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+    const size_t anchors = 8400;
+    const size_t classes = 80;
+    const float threshold = 0.25f;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> noise(0.0f, 0.05f);
+    std::uniform_real_distribution<float> peak(0.2f, 0.95f);
+    std::vector<float> scores(anchors * classes);
+    for (auto& score : scores)
+        score = noise(random);
+    for (size_t i = 0; i < anchors; i += 20)
+        scores[i * classes + random() % classes] = peak(random);
+
+    std::vector<Candidate> expected;
+    std::vector<Candidate> actual;
+    std::cout << "best kernel: " << simdLevelName(supportedSimdLevel()) << ", " << iterations << " iterations" << std::endl;
+
+    double loopSingle = averageMs([&]() { expected.clear(); loopMaxScores(scores.data(), anchors, classes, threshold, expected); }, iterations);
+    std::cout << "single label:\tmax_element loop " << loopSingle << "ms\t" << expected.size() << " candidates" << std::endl;
+    for (int level = 0; level <= static_cast<int>(supportedSimdLevel()); level++) {
+        setSimdLevel(static_cast<SimdLevel>(level));
+        double scanSingle = averageMs([&]() { actual.clear(); scanMaxScores(scores.data(), anchors, classes, threshold, actual); }, iterations);
+        std::cout << "\tscan " << scoreScanKernel() << " " << scanSingle << "ms" << (same(expected, actual) ? "" : " MISMATCH") << std::endl;
+    }
+
+    double loopMulti = averageMs([&]() { expected.clear(); loopAllScores(scores.data(), anchors, classes, threshold, expected); }, iterations);
+    std::cout << "multi label:\tnested loop " << loopMulti << "ms\t" << expected.size() << " candidates" << std::endl;
+    for (int level = 0; level <= static_cast<int>(supportedSimdLevel()); level++) {
+        setSimdLevel(static_cast<SimdLevel>(level));
+        double scanMulti = averageMs([&]() { actual.clear(); scanAllScores(scores.data(), anchors, classes, threshold, actual); }, iterations);
+        std::cout << "\tscan " << scoreScanKernel() << " " << scanMulti << "ms" << (same(expected, actual) ? "" : " MISMATCH") << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
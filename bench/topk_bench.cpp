@@ -0,0 +1,98 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "processing.hpp"
+#include "score-scan.hpp"
+
+// Compares selecting the nms_top_k best candidates with selectTopK() against
+// the previous sort of every materialized Box, for score thresholds from
+// 0.01 to 0.5 on a multi-label [8400 x 80] score tensor. Low thresholds let
+// tens of thousands of candidates through.
+
+static Box toBox(const float* bboxes, const Candidate& candidate)
+{
+    const float* bbox = bboxes + candidate.anchor * 4;
+    return { bbox[0], bbox[1], bbox[2], bbox[3], candidate.score, static_cast<float>(candidate.class_id) };
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 100;
+    const size_t anchors = 8400;
+    const size_t classes = 80;
+    const size_t topK = 1000;
+
+    // background scores fall off exponentially, a quarter of the anchors
+    // see an object with a confidence anywhere between 0.05 and 0.95
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::exponential_distribution<float> background(250.0f);
+    std::vector<float> scores(anchors * classes);
+    for (auto& score : scores)
+        score = std::min(background(random), 0.05f);
+    for (size_t i = 0; i < anchors; i += 4)
+        scores[i * classes + random() % classes] = 0.05f + 0.9f * uniform(random);
+    std::vector<float> bboxes(anchors * 4);
+    for (auto& coordinate : bboxes)
+        coordinate = uniform(random) * 640.0f;
+
+    std::vector<Candidate> scanned, candidates;
+    std::vector<Box> expected, actual;
+    for (float threshold : { 0.01f, 0.02f, 0.05f, 0.1f, 0.25f, 0.5f }) {
+        scanned.clear();
+        scanAllScores(scores.data(), anchors, classes, threshold, scanned);
+
+        double sortAll = averageMs([&]() {
+            expected.clear();
+            for (const auto& candidate : scanned)
+                expected.push_back(toBox(bboxes.data(), candidate));
+            std::sort(expected.begin(), expected.end(), [](const Box& a, const Box& b) { return a.confidence > b.confidence; });
+            if (expected.size() > topK)
+                expected.resize(topK);
+        }, iterations);
+
+        double select = averageMs([&]() {
+            candidates = scanned;
+            selectTopK(candidates, topK);
+            actual.clear();
+            for (const auto& candidate : candidates)
+                actual.push_back(toBox(bboxes.data(), candidate));
+        }, iterations);
+
+        bool same = std::equal(expected.begin(), expected.end(), actual.begin(), actual.end(),
+                               [](const Box& a, const Box& b) { return a.confidence == b.confidence; });
+        std::cout << "threshold " << std::setw(4) << threshold << ":\t" << std::setw(6) << scanned.size() << " candidates"
+                  << "\tsort boxes " << sortAll << "ms\tselectTopK " << select << "ms" << (same ? "" : " MISMATCH") << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// Replaces the global operator new and delete to count every heap
+// allocation of the process, aligned ones included. The array and nothrow
+// forms forward to these by default. Include it from exactly one source
+// file of an executable.
+
+inline std::atomic<size_t> allocations{ 0 };
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// the aligned buffers of the NMS and the postprocessor come from here
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocations++;
+    std::size_t bytes = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    void *memory = _aligned_malloc(size ? size : 1, bytes);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    void *memory = std::aligned_alloc(bytes, ((size ? size : 1) + bytes - 1) / bytes * bytes);
+#endif
+    if (memory)
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(memory, alignment);
+}
+
+// Adds the allocations made during its lifetime to total, to count only
+// the calls under test rather than everything around them
+class CountAllocations
+{
+public:
+    explicit CountAllocations(size_t &total) : total(total), start(allocations) {}
+    ~CountAllocations() { total += allocations - start; }
+
+    CountAllocations(const CountAllocations &) = delete;
+    CountAllocations &operator=(const CountAllocations &) = delete;
+
+private:
+    size_t &total;
+    size_t start;
+};
\ No newline at end of file
@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include <vector>
 
+#include "config.hpp"
+
 enum Source
 {
     IMAGE,
@@ -38,10 +40,10 @@ struct Args
     std::string modelPath;
     Source type;
     std::string source;
-    std::vector<int> imgSize;
-    bool gpu;
-    float scoreThresh;
-    float iouThresh;
+    bool async;
+    int batchSize;
+    YoloNASConfig config;
+    bool hugePages;
 };
 
 Args parseArgs(int argc, char **argv);
\ No newline at end of file
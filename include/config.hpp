@@ -0,0 +1,82 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// OpenVINO compile properties. Empty strings and zero/negative values keep
+// whatever the plugin picks by default.
+struct DeviceConfig
+{
+    bool gpu = false;
+    std::string performanceMode;    // LATENCY, THROUGHPUT or CUMULATIVE_THROUGHPUT
+    std::string numStreams;         // a number or AUTO
+    int numThreads = 0;
+    int cpuPinning = -1;            // 0 = off, 1 = on
+    std::string schedulingCoreType; // ANY_CORE, PCORE_ONLY or ECORE_ONLY
+    int numRequests = 1;            // 0 = ov::optimal_number_of_infer_requests, per instance
+};
+
+// Latency of the first inference after compiling versus the average of the
+// following warm-up inferences
+struct WarmupReport
+{
+    float coldMs = 0.0f;
+    float warmMs = 0.0f;
+    int runs = 0;
+};
+
+struct YoloNASConfig
+{
+    std::vector<int> imgSize{ 640, 640 };
+    float scoreThresh = 0.25f;
+    float iouThresh = 0.45f;
+    int nmsTopK = 1000;
+    std::vector<int> classes;       // only detect these class ids, the others are dropped in the graph (empty = all)
+    int maxPredictions = 300;
+    bool multiLabel = false;        // keep every class above the threshold, not just the best one
+    bool graphNms = false;          // run NMS inside the OpenVINO graph
+    bool graphMaxScore = false;     // reduce the scores to the best class of each anchor inside the graph
+    int graphTopK = 0;              // with graphMaxScore, only the K best anchors leave the graph (0 = all)
+    std::string nmsMethod = "sweep"; // or offset, see NmsMethod
+    int batchSize = 1;              // 0 = dynamic batch dimension
+    std::string preprocess = "kernel"; // see preprocessorNames()
+    std::string inputFormat = "bgr"; // bgr, or nv12/i420 planes converted and resized in the graph
+    bool pppResize = false;         // resize in the OpenVINO graph instead of letterbox(), same as preprocess = "ppp"
+    bool reducedDecode = true;      // readImage() decodes large JPEGs at reduced size
+    bool rect = false;              // pad to the next multiple of the stride instead of a square
+    bool tile = false;              // infer overlapping imgsz tiles of large images
+    float tileOverlap = 0.2f;       // fraction of a tile shared with its neighbour
+    std::string cacheDir = ".cache";
+    bool compiledBlob = false;      // export the compiled model once, import it on later runs
+    bool numa = false;              // one CPU instance per NUMA node
+    std::string numaDispatch = "round-robin"; // or least-load
+    bool watchModel = false;        // reload the model when its files change
+    int warmup = 0;                 // synthetic inferences per infer request before serving
+    std::function<void(const WarmupReport &)> onReady; // called at the end of the constructor, once the detector is warmed up
+    DeviceConfig device;
+};
\ No newline at end of file
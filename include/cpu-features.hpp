@@ -0,0 +1,59 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Instruction sets the SIMD kernels (letterbox, score scan, NMS) are built
+// for. Every kernel is compiled for each of them with function target
+// attributes and picked at run time, so a default build runs the AVX2 or
+// AVX-512 code on CPUs that have it and plain C++ everywhere else.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define YOLO_NAS_SIMD 1
+#define YOLO_NAS_TARGET_AVX2 __attribute__((target("avx2")))
+#define YOLO_NAS_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#elif defined(_M_X64) && defined(_MSC_VER)
+// MSVC emits any intrinsic without extra flags
+#define YOLO_NAS_SIMD 1
+#define YOLO_NAS_TARGET_AVX2
+#define YOLO_NAS_TARGET_AVX512
+#else
+#define YOLO_NAS_SIMD 0
+#endif
+
+enum class SimdLevel
+{
+    Scalar,
+    AVX2,
+    // AVX-512F and AVX-512BW
+    AVX512,
+};
+
+// Best level this build and the CPU (and OS) support, detected once
+SimdLevel supportedSimdLevel();
+// Level the kernels currently run, supportedSimdLevel() unless lowered
+SimdLevel simdLevel();
+// Runs the kernels at a lower level, e.g. to compare them in benchmarks.
+// Levels above supportedSimdLevel() are clamped.
+void setSimdLevel(SimdLevel level);
+const char *simdLevelName(SimdLevel level);
\ No newline at end of file
@@ -39,10 +39,10 @@ private:
     int n = (int)palette.size();
 
 public:
-    inline cv::Scalar get(int i)
+    inline cv::Scalar get(int i) const
     {
         return palette[i % n];
     }
 };
 
-void drawBoxes(cv::Mat& image, const std::vector<std::vector<Box>>& boxes, float width_ratio, float height_ratio);
\ No newline at end of file
+void drawBoxes(cv::Mat& image, const std::vector<Box>& boxes, float width_ratio, float height_ratio);
\ No newline at end of file
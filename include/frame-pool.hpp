@@ -0,0 +1,68 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// Fixed number of equally sized frame buffers carved from one arena that is
+// allocated once, 64-byte aligned and, on Linux, optionally backed by
+// transparent huge pages. Frames are cv::Mat headers over the arena, so
+// handing them out and back allocates nothing.
+class FramePool
+{
+public:
+    FramePool(size_t count, bool hugePages = false);
+    ~FramePool();
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    // A free buffer viewed as a [size] image of the given type. The arena is
+    // sized by the first call; frames that do not fit, or requests while every
+    // buffer is out, get a regular heap Mat instead.
+    cv::Mat acquire(cv::Size size, int type);
+    // Returns the buffer behind frame, frames that did not come from the
+    // pool are ignored
+    void release(const cv::Mat &frame);
+
+    size_t size() const;
+    // Number of buffers currently handed out
+    size_t busy() const;
+
+private:
+    void allocate(size_t bytes);
+
+    size_t count;
+    bool hugePages;
+    unsigned char *arena = nullptr;
+    size_t arenaBytes = 0;
+    size_t slotBytes = 0;
+    std::vector<bool> used;
+    mutable std::mutex mutex;
+};
\ No newline at end of file
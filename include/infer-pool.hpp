@@ -0,0 +1,78 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include <openvino/openvino.hpp>
+
+// Fixed set of infer requests created from one compiled model, which the pool
+// keeps alive for as long as it exists. Requests are
+// handed out with acquire() and returned with release(), so several frames can
+// be in flight at once while the caller keeps pre/post-processing others.
+class InferencePool
+{
+public:
+    InferencePool(const ov::CompiledModel &compiledModel, size_t size);
+    ~InferencePool();
+
+    InferencePool(const InferencePool &) = delete;
+    InferencePool &operator=(const InferencePool &) = delete;
+
+    size_t size() const;
+    // Number of requests currently handed out
+    size_t busy() const;
+    ov::CompiledModel &compiledModel();
+
+    // Blocks until a request is free and marks it as busy.
+    size_t acquire();
+    // Non-blocking acquire(), returns false when every request is busy
+    bool tryAcquire(size_t &id);
+    void release(size_t id);
+
+    ov::InferRequest &request(size_t id);
+
+    // Starts the request asynchronously; completion is reported through the
+    // request callback and collected with wait().
+    void start(size_t id);
+    void wait(size_t id);
+
+private:
+    struct Slot
+    {
+        ov::InferRequest request;
+        bool busy = false;
+        bool running = false;
+        std::exception_ptr error;
+    };
+
+    ov::CompiledModel compiled;
+    std::vector<Slot> slots;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+};
\ No newline at end of file
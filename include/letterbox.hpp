@@ -0,0 +1,43 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Nearest-neighbour resize of a packed 3-channel 8-bit image into the top-left
+// [contentWidth x contentHeight] corner of dst, with the rest of dst set to
+// zero, in a single pass. Every output pixel is read straight from the source
+// and the padding is written without reading anything. swapRB turns BGR into
+// RGB (and back) on the way. Strides are in bytes.
+//
+// Uses AVX-512BW or AVX2 gathers when the CPU has them, see simdLevel(),
+// and plain C++ otherwise.
+void letterboxNearest(const uint8_t *src, int srcWidth, int srcHeight, size_t srcStride,
+                      uint8_t *dst, int dstWidth, int dstHeight, size_t dstStride,
+                      int contentWidth, int contentHeight, bool swapRB = false);
+
+// Name of the code path letterboxNearest() runs
+const char *letterboxKernel();
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "box-store.hpp"
+
+struct Box;
+
+enum class NmsMethod
+{
+    // class buckets, each swept in x so only horizontally overlapping boxes
+    // are compared
+    Sweep,
+    // every box sorted by x1 + class_id * (largest x + 1) so classes form
+    // separate ranges, then one sweep over all boxes (batched NMS); the IoU
+    // uses the original coordinates
+    Offset,
+};
+
+// Buffers of nonMaxSuppression(), they keep their capacity between calls
+struct NmsWorkspace
+{
+    std::vector<size_t> byClass;
+    std::vector<size_t> members;
+    std::vector<size_t> byX;
+    std::vector<size_t> position;
+    // sort key of every box of the store, shifted x1 for NmsMethod::Offset
+    std::vector<double> key;
+    std::vector<uint8_t> keep;
+    BoxStore store;
+    AlignedVector<int32_t> suppressed;
+};
+
+// Greedy class-aware NMS over boxes sorted by descending confidence. Returns
+// the indices of the kept boxes in that order; same result as comparing
+// every pair of the same class, for thresholds >= 0. The boxes are copied to
+// a BoxStore and each kept box is tested against 8 (AVX2) or 16 (AVX-512)
+// neighbours at once.
+std::vector<size_t> nonMaxSuppression(const std::vector<Box> &boxes, float iouThreshold, NmsMethod method = NmsMethod::Sweep);
+// Same, with the buffers and the kept indices reused from earlier calls, so
+// nothing is allocated once they have grown to the largest input
+void nonMaxSuppression(const std::vector<Box> &boxes, float iouThreshold, NmsMethod method, NmsWorkspace &workspace, std::vector<size_t> &kept);
+
+// Name of the code path the IoU loop runs
+const char *nmsKernel();
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+
+struct NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+// NUMA nodes that have CPUs, read from sysfs. Empty on platforms where the
+// topology is unknown.
+std::vector<NumaNode> numaNodes();
+
+// Restricts the calling thread to the given CPUs. Threads it creates
+// afterwards inherit the mask, and memory it touches first is allocated on
+// the local node.
+bool pinCurrentThread(const std::vector<int>& cpus);
+
+// Thread ids of this process, empty where they cannot be listed
+std::vector<int> processThreads();
+// CPUs the thread may run on, empty where unknown
+std::vector<int> threadCpus(int tid);
+// Restricts another thread of this process to the given CPUs
+bool pinThread(int tid, const std::vector<int>& cpus);
\ No newline at end of file
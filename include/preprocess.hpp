@@ -0,0 +1,81 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// How frames are scaled into the model input. Every backend fills the
+// top-left [content] corner of dst and zeroes the rest of it.
+class Preprocessor
+{
+public:
+    virtual ~Preprocessor() = default;
+
+    virtual std::string name() const = 0;
+    // The model graph resizes the frames itself, letterbox() is skipped
+    virtual bool resizesInGraph() const { return false; }
+    virtual void resize(const cv::Mat &source, cv::Mat &dst, cv::Size content) const = 0;
+};
+
+// cv::resize with the given interpolation
+class OpenCVPreprocessor : public Preprocessor
+{
+public:
+    OpenCVPreprocessor(int interpolation);
+
+    std::string name() const override;
+    void resize(const cv::Mat &source, cv::Mat &dst, cv::Size content) const override;
+
+private:
+    int interpolation;
+};
+
+// The fused letterboxNearest() kernel, cv::resize for other than 8UC3 images
+class KernelPreprocessor : public Preprocessor
+{
+public:
+    std::string name() const override;
+    void resize(const cv::Mat &source, cv::Mat &dst, cv::Size content) const override;
+};
+
+// Bilinear resize in the OpenVINO PPP graph, resize() is only used when
+// letterbox() is called directly
+class OpenVINOPreprocessor : public OpenCVPreprocessor
+{
+public:
+    OpenVINOPreprocessor();
+
+    std::string name() const override;
+    bool resizesInGraph() const override { return true; }
+};
+
+// Backend names accepted by createPreprocessor()
+std::vector<std::string> preprocessorNames();
+// Throws std::invalid_argument for unknown names
+std::unique_ptr<Preprocessor> createPreprocessor(const std::string &name);
\ No newline at end of file
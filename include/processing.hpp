@@ -27,24 +27,58 @@ SOFTWARE.
 #include <vector>
 #include <openvino/openvino.hpp>
 
+#include "nms.hpp"
+#include "score-scan.hpp"
+
 struct Box {
     float x1, y1, x2, y2, confidence, class_id;
 };
 
+// Buffers the postprocessor reuses between frames. They grow to the busiest
+// frame seen and keep that capacity.
+struct PostprocessWorkspace {
+    std::vector<Candidate> candidates;
+    std::vector<Box> boxes;
+    std::vector<size_t> kept;
+    NmsWorkspace nms;
+};
+
 class PPYoloEPostPredictionCallback {
 public:
-    PPYoloEPostPredictionCallback(float score_threshold, float nms_threshold, int nms_top_k, int max_predictions, bool multi_label_per_box = true);
-    std::vector<std::vector<Box>> forward(float* pred_bboxes, float* pred_scores, ov::Shape output_shape_bboxes, ov::Shape output_shape_scores);
+    // class_ids maps the class channels of the model output to the class ids
+    // reported in Box::class_id, empty when the output has every class
+    PPYoloEPostPredictionCallback(float score_threshold, float nms_threshold, int nms_top_k, int max_predictions, bool multi_label_per_box = true, NmsMethod nms_method = NmsMethod::Sweep, const std::vector<int>& class_ids = {});
+    // Writes the boxes of the first count images of a [N, anchors, 4] box and
+    // [N, anchors, classes] score output to results[0..count). The result
+    // vectors are cleared, not replaced, so with the workspace warmed up a call
+    // does not allocate. The workspace makes this non-const: use one
+    // postprocessor per thread.
+    void forward(const float* pred_bboxes, const float* pred_scores, size_t anchors, size_t classes, std::vector<Box>* results, size_t count);
+    // Returns one list of boxes per image of the batch
+    std::vector<std::vector<Box>> forward(const float* pred_bboxes, const float* pred_scores, const ov::Shape& output_shape_bboxes, const ov::Shape& output_shape_scores);
+    // forward() for a graph that already reduced the scores: [N, rows, 4] boxes
+    // and [N, rows, 2] (score, class) pairs of the best class of each row
+    void forwardBest(const float* pred_bboxes, const float* pred_best, size_t rows, std::vector<Box>* results, size_t count);
+    // Unpacks the [K, 6] (class, score, x1, y1, x2, y2) output of an in-graph
+    // MulticlassNms, counts holds the number of detections of each image
+    void forwardNms(const float* detections, const int32_t* counts, std::vector<Box>* results, size_t count) const;
+    std::vector<std::vector<Box>> forwardNms(const float* detections, const int32_t* counts, size_t batch) const;
+    // Class-aware NMS over boxes gathered from several inferences, e.g. tiles
+    std::vector<Box> merge(std::vector<Box> boxes);
 
 private:
-    std::vector<std::vector<Box>> _filter_max_predictions(std::vector<std::vector<Box>>& res) const;
-    std::vector<size_t> performNMS(const std::vector<Box>& boxes, const std::vector<float>& scores, const std::vector<size_t>& indices, float iou_threshold) const;
-    float calculateIntersection(const Box& box1, const Box& box2) const;
-    float calculateArea(const Box& box) const;
+    void forwardImage(const float* pred_bboxes, const float* pred_scores, size_t anchors, size_t classes, std::vector<Box>& result);
+    // Top-k of the scanned candidates, then boxes and NMS
+    void forwardCandidates(const float* pred_bboxes, std::vector<Box>& result);
+    // Appends the boxes that survive NMS to result
+    void suppress(const std::vector<Box>& boxes, std::vector<Box>& result);
 
     float score_threshold;
     float nms_threshold;
     int nms_top_k;
     int max_predictions;
     bool multi_label_per_box;
+    NmsMethod nms_method;
+    std::vector<float> class_ids;
+    PostprocessWorkspace workspace;
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Score above the threshold for one anchor and class
+struct Candidate
+{
+    float score;
+    uint32_t anchor;
+    uint32_t class_id;
+};
+
+// Streams a row-major [anchors x classes] score tensor once and appends the
+// candidates to out, in anchor order.
+//
+// Single label: the best class of every anchor whose best score is
+// >= threshold, ties go to the lowest class index.
+void scanMaxScores(const float *scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate> &out);
+// Multi label: every anchor and class with a score > threshold
+void scanAllScores(const float *scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate> &out);
+
+// Keeps the k best candidates and sorts them by descending score. Only the
+// 12-byte candidates are moved, so call it before building boxes.
+void selectTopK(std::vector<Candidate> &candidates, size_t k);
+
+// Name of the code path the scans run
+const char *scoreScanKernel();
\ No newline at end of file
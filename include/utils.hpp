@@ -25,6 +25,10 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 std::string LogInfo(std::string header, std::string body);
 
 std::string LogWarning(std::string header, std::string body);
@@ -33,6 +37,12 @@ std::string LogError(std::string header, std::string body);
 
 void exists(std::string path);
 
+// 64-bit FNV-1a, pass the previous hash as seed to chain inputs
+uint64_t hashString(const std::string& data, uint64_t seed = 14695981039346656037ULL);
+
+// FNV-1a of the file contents, taken 8 bytes at a time
+uint64_t hashFile(const std::string& path, uint64_t seed = 14695981039346656037ULL);
+
 const std::vector<std::string> COCO_LABELS{"person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat",
                                            "traffic light", "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat",
                                            "dog", "horse", "sheep", "cow", "elephant", "bear", "zebra", "giraffe", "backpack",
@@ -24,24 +24,188 @@ SOFTWARE.
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 
+#include "config.hpp"
+#include "infer-pool.hpp"
+#include "numa.hpp"
+#include "preprocess.hpp"
 #include "processing.hpp"
 
+// x and y scale from the model input (or a reduced decode) to the image
+using Ratios = std::array<float, 2>;
+
 class YoloNAS
 {
 private:
+    using PoolSet = std::vector<std::shared_ptr<InferencePool>>;
+
     int modelInputShape[4] = { 1, 3, 0, 0 };
-    float scoreTresh;
-    float iouTresh;
+    static constexpr int modelStride = 32;
+    YoloNASConfig config;
+    std::string modelPath;
+    std::string device;
+    std::unique_ptr<Preprocessor> preprocessor;
 
-public:
-    std::shared_ptr<ov::InferRequest> infer_request;
+    struct PendingFrame
+    {
+        std::shared_ptr<InferencePool> pool;
+        size_t request;
+        cv::Mat image;
+        Ratios ratios;
+    };
+    // ring of pendingCount frames from pendingHead on, sized to the infer
+    // requests so submit() and retrieve() do not allocate
+    std::vector<PendingFrame> pendingFrames;
+    size_t pendingHead = 0;
+    size_t pendingCount = 0;
+    std::atomic<size_t> nextInstance{ 0 };
+
+    // one instance, or one per NUMA node; replaced as a whole on reload
+    std::shared_ptr<const PoolSet> infer_pools;
+    mutable std::mutex poolsMutex;
+
+    std::thread reloader;
+    std::thread watcher;
+    std::mutex reloadMutex;
+    std::condition_variable reloadCv;
+    bool reloading = false;
+    bool stopping = false;
+
+    // Postprocessors keep their buffers between frames, so each thread takes
+    // one of its own for the duration of a frame
+    std::vector<std::unique_ptr<PPYoloEPostPredictionCallback>> idlePostprocessors;
+    std::mutex postprocessorsMutex;
+    // boxes of the last retrieve(img), reused across frames
+    std::vector<Box> retrievedBoxes;
+
+    // Instances for the current device, one per NUMA node when enabled
+    PoolSet createPools(ov::Core &core, const std::string &modelPath);
+    std::shared_ptr<InferencePool> createPool(ov::Core &core, const std::string &modelPath, const std::string &device, const ov::AnyMap &overrides = {});
+    // Compiles an instance from a thread bound to the node's CPUs
+    std::shared_ptr<InferencePool> createNumaPool(ov::Core &core, const std::string &modelPath, const NumaNode &node);
+    // Instance the next request is taken from, round robin or least loaded
+    std::shared_ptr<InferencePool> nextPool();
+    // Instances new frames are sent to
+    std::shared_ptr<const PoolSet> pools() const;
+    // Runs config.warmup synthetic inferences on every infer request
+    WarmupReport warmup(const PoolSet &pools);
+    // Reloads the model once its files changed, until destruction
+    void watchModel();
+
+    std::shared_ptr<ov::Model> buildModel(ov::Core &core, const std::string &modelPath);
+    // Keeps only the score channels of config.classes, in that order
+    std::shared_ptr<ov::Model> selectClasses(const std::shared_ptr<ov::Model> &model) const;
+    // Appends MulticlassNms so the model only outputs the final detections
+    std::shared_ptr<ov::Model> appendNms(const std::shared_ptr<ov::Model> &model) const;
+    // Replaces the score output with the (score, class) of the best class of
+    // every anchor, optionally only for the graphTopK best anchors
+    std::shared_ptr<ov::Model> appendMaxScore(const std::shared_ptr<ov::Model> &model) const;
+    // Compiles the model, or imports it from the compiled blob cache when enabled
+    ov::CompiledModel compile(ov::Core &core, const std::string &modelPath, const std::string &device, const ov::AnyMap &overrides = {});
+    std::filesystem::path compiledBlobPath(const std::string &modelPath, const std::string &device, const ov::AnyMap &properties) const;
+    // Hash of the .xml and .bin, only read again when their path, size or
+    // modification time changed, so NUMA nodes and reloads of the same
+    // files reuse it
+    uint64_t modelFilesHash(const std::string &modelPath) const;
+    mutable std::mutex modelHashMutex;
+    mutable std::string modelHashStamp;
+    mutable uint64_t modelHash = 0;
+
+    // Smallest image size preprocessing needs to not upscale the image
+    cv::Size decodeSize(cv::Size image) const;
+    // Smallest stride-aligned canvas that holds the image at imgsz scale
+    cv::Size rectShape(const cv::Mat &source) const;
+    // Letterboxes the images directly into the request's input tensor
+    void fillInput(ov::InferRequest &request, const cv::Mat *images, size_t count, Ratios *ratios);
+    // Hands the decoded images to a model that resizes them in its PPP graph
+    void fillRawInput(ov::InferRequest &request, const cv::Mat *images, size_t count, Ratios *ratios);
+    // Black planes of the configured YUV format, empty for BGR input
+    std::vector<cv::Mat> yuvPlanes(cv::Size size) const;
+    // Hands Y/UV or Y/U/V planes to a model with the color conversion in its graph
+    void fillPlanes(ov::InferRequest &request, const cv::Mat *planes, size_t count);
+    std::vector<Box> detectPlanes(const cv::Mat *planes, size_t count);
+    // Writes the boxes of the first count images of the request to results
+    void postprocess(ov::InferRequest &request, size_t count, std::vector<Box> *results);
+    // An idle postprocessor, or a new copy of postprocessor when all are busy
+    std::unique_ptr<PPYoloEPostPredictionCallback> takePostprocessor();
+    void returnPostprocessor(std::unique_ptr<PPYoloEPostPredictionCallback> callback);
+
+    // Maps boxes from model input to image coordinates
+    static void scaleBoxes(std::vector<Box> &boxes, const Ratios &ratios);
+    // Runs the images in chunks of the compiled batch size, spread over the
+    // free infer requests, and writes boxes in image coordinates to results
+    void detectBatch(const cv::Mat *images, size_t count, std::vector<Box> *results);
+    // Runs the full image and overlapping imgsz tiles as one batch, then
+    // merges the tile results with a cross-tile NMS
+    std::vector<Box> detectTiled(const cv::Mat &img);
+
+    // first instance of the current model, replaced on reload under poolsMutex
     std::shared_ptr<ov::CompiledModel> compiled_model;
+
+public:
     std::vector<int> imgSize;
-    YoloNAS(std::string model_path, std::vector<int> imgsz, bool cuda, float scoreTresh, float iouTresh);
-    void letterbox(cv::Mat &source, cv::Mat &dst, std::vector<float> &ratios);
+    YoloNAS(std::string model_path, const YoloNASConfig &config);
+    ~YoloNAS();
+
+    YoloNAS(const YoloNAS &) = delete;
+    YoloNAS &operator=(const YoloNAS &) = delete;
+
+    // First instance of the current model. The pointer is a snapshot, a later
+    // reload does not change the model it points to.
+    std::shared_ptr<ov::CompiledModel> compiledModel() const;
+    // Prints the properties the device actually compiled the model with
+    void printProperties() const;
+    // Compiles the model at path (the current one when empty) in the background
+    // and switches new frames over once it is ready, frames already in flight
+    // finish on the old model. Returns false when a reload is still running.
+    bool reload(const std::string &path = "");
+    // Decodes an image file. Large JPEGs are decoded at 1/2, 1/4 or 1/8 of
+    // their size when that still covers the model input, ratios maps the
+    // decoded image back to the original size.
+    cv::Mat readImage(const std::string &path, Ratios &ratios);
+    // dst is allocated when empty, otherwise it must be a CV_8UC3 canvas large
+    // enough for the scaled image ([H x W], or rectShape() in rect mode)
+    void letterbox(const cv::Mat &source, cv::Mat &dst, Ratios &ratios);
+    // Boxes in original image coordinates, nothing is drawn. Safe to call from
+    // several threads at once, each call takes its own infer requests.
+    std::vector<Box> detect(const cv::Mat &img);
+    // detect() into a caller-owned vector, which keeps its capacity across
+    // frames
+    void detect(const cv::Mat &img, std::vector<Box> &boxes);
+    // Runs the images through the model in batches of the compiled batch size
+    std::vector<std::vector<Box>> detect(const std::vector<cv::Mat> &imgs);
+    // Frames straight from a decoder, for models built with inputFormat nv12
+    // or i420. y is the CV_8UC1 luma plane, uv the interleaved CV_8UC2 chroma
+    // plane, u and v the CV_8UC1 chroma planes, all continuous. Boxes are in
+    // luma plane coordinates.
+    std::vector<Box> detectNV12(const cv::Mat &y, const cv::Mat &uv);
+    std::vector<Box> detectI420(const cv::Mat &y, const cv::Mat &u, const cv::Mat &v);
+    // detect() and draws the boxes onto the images
     void predict(cv::Mat &img);
+    void predict(std::vector<cv::Mat> &imgs);
+
+    // Pipelined inference: submit() starts a frame on a free infer request and
+    // retrieve() returns the oldest submitted frame with its detections drawn,
+    // so results come back in submission order. Call retrieve() before
+    // submit() once pending() == numRequests(), otherwise submit() blocks.
+    // Unlike detect(), the queue belongs to a single thread.
+    void submit(cv::Mat &img);
+    bool retrieve(cv::Mat &img);
+    // retrieve() that returns the boxes instead of drawing them, boxes is
+    // cleared and refilled
+    bool retrieve(cv::Mat &img, std::vector<Box> &boxes);
+    size_t pending() const;
+    size_t numRequests() const;
+
+    // Settings every per-thread postprocessor is copied from
     PPYoloEPostPredictionCallback postprocessor;
 };
\ No newline at end of file
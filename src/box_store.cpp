@@ -0,0 +1,47 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "box-store.hpp"
+
+void BoxStore::clear()
+{
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+    area.clear();
+    class_id.clear();
+    index.clear();
+}
+
+void BoxStore::push_back(float left, float top, float right, float bottom, int32_t label, size_t position)
+{
+    x1.push_back(left);
+    y1.push_back(top);
+    x2.push_back(right);
+    y2.push_back(bottom);
+    area.push_back((right - left) * (bottom - top));
+    class_id.push_back(label);
+    index.push_back(position);
+}
\ No newline at end of file
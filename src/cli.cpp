@@ -23,9 +23,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+#include <cctype>
+
 #include "argparse.hpp"
 #include "utils.hpp"
 #include "cli.hpp"
+#include "preprocess.hpp"
 
 Args parseArgs(int argc, char **argv)
 {
@@ -33,7 +37,7 @@ Args parseArgs(int argc, char **argv)
     program.add_description("YOLO-NAS OpenVINO detection");
 
     program.add_argument("--model").help("Path to the YOLO-NAS ONNX model.").metavar("MODEL");
-    program.add_argument("-i", "--image").help("Path to the image source").metavar("IMAGE");
+    program.add_argument("-i", "--image").help("Path to the image source or a directory of images").metavar("IMAGE");
     program.add_argument("-v", "--video").help("Path to the video source").metavar("VIDEO");
 
     program.add_argument("--imgsz")
@@ -52,6 +56,109 @@ Args parseArgs(int argc, char **argv)
         .default_value(0.45f)
         .help("Minimum IoU threshold while applying NMS")
         .scan<'g', float>();
+    program.add_argument("--async")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Pipeline video frames over several asynchronous infer requests");
+    program.add_argument("--nireq")
+        .default_value(0)
+        .help("Number of infer requests in async mode (0 = device optimal)")
+        .scan<'i', int>();
+    program.add_argument("--batch")
+        .default_value(1)
+        .help("Number of images per inference")
+        .scan<'i', int>();
+    program.add_argument("--dynamic-batch")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Compile the model with a dynamic batch dimension");
+    program.add_argument("--ppp-resize")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Resize frames inside the OpenVINO graph instead of letterboxing with OpenCV (same as --preprocess ppp)");
+    program.add_argument("--preprocess")
+        .default_value(std::string("kernel"))
+        .help("Preprocessing backend: kernel, opencv-nearest, opencv-linear, opencv-area or ppp");
+    program.add_argument("--input-format")
+        .default_value(std::string("bgr"))
+        .help("Frames handed to the model: bgr, or nv12/i420 planes converted to BGR inside the graph");
+    program.add_argument("--full-decode")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Always decode images at full resolution instead of a reduced JPEG decode");
+    program.add_argument("--rect")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Keep the aspect ratio and pad only up to a multiple of 32");
+    program.add_argument("--tile")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Infer large images as overlapping imgsz tiles in one batch");
+    program.add_argument("--tile-overlap")
+        .default_value(0.2f)
+        .help("Fraction of a tile overlapping its neighbour")
+        .scan<'g', float>();
+    program.add_argument("--perf-mode")
+        .default_value(std::string(""))
+        .help("OpenVINO performance hint: LATENCY, THROUGHPUT or CUMULATIVE_THROUGHPUT");
+    program.add_argument("--num-streams")
+        .default_value(std::string(""))
+        .help("Number of inference streams or AUTO");
+    program.add_argument("--threads")
+        .default_value(0)
+        .help("Number of inference threads (0 = device default)")
+        .scan<'i', int>();
+    program.add_argument("--cpu-pinning")
+        .default_value(std::string(""))
+        .help("Pin inference threads to CPU cores: on or off");
+    program.add_argument("--core-type")
+        .default_value(std::string(""))
+        .help("CPU cores to schedule on: ANY_CORE, PCORE_ONLY or ECORE_ONLY");
+    program.add_argument("--cache-dir")
+        .default_value(std::string(".cache"))
+        .help("Directory for the OpenVINO model cache and compiled blobs");
+    program.add_argument("--compiled-blob")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Export the compiled model on the first run and import it afterwards");
+    program.add_argument("--graph-nms")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Run score filtering and NMS inside the OpenVINO graph");
+    program.add_argument("--classes")
+        .help("Only detect these classes, by id or COCO name")
+        .nargs(argparse::nargs_pattern::at_least_one)
+        .default_value(std::vector<std::string>{});
+    program.add_argument("--graph-max-score")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Reduce the scores to the best class of each anchor inside the OpenVINO graph");
+    program.add_argument("--graph-topk")
+        .default_value(0)
+        .help("With --graph-max-score, only read back the K best anchors (0 = all)")
+        .scan<'i', int>();
+    program.add_argument("--nms-method")
+        .default_value(std::string("sweep"))
+        .help("Host NMS: sweep (per class) or offset (all classes in one pass)");
+    program.add_argument("--numa")
+        .default_value(false)
+        .implicit_value(true)
+        .help("Run one CPU instance per NUMA node");
+    program.add_argument("--numa-dispatch")
+        .default_value(std::string("round-robin"))
+        .help("How frames are spread over NUMA instances: round-robin or least-load");
+    program.add_argument("--watch-model")
+        .help("Reload the model in the background when its files change")
+        .default_value(false)
+        .implicit_value(true);
+    program.add_argument("--huge-pages")
+        .help("Back the video frame buffers with transparent huge pages (Linux)")
+        .default_value(false)
+        .implicit_value(true);
+    program.add_argument("--warmup")
+        .default_value(0)
+        .help("Synthetic inferences per infer request before the first frame")
+        .scan<'i', int>();
 
     try
     {
@@ -68,6 +175,34 @@ Args parseArgs(int argc, char **argv)
     bool useGPU = program.get<bool>("--gpu");
     float scoreThresh = program.get<float>("--score-thresh");
     float iouThresh = program.get<float>("--iou-thresh");
+    bool async = program.get<bool>("--async");
+    int numRequests = program.get<int>("--nireq");
+    int batchSize = program.get<int>("--batch");
+    bool dynamicBatch = program.get<bool>("--dynamic-batch");
+    std::string preprocess = program.get<std::string>("--preprocess");
+    bool pppResize = program.get<bool>("--ppp-resize") || preprocess == "ppp";
+    bool rect = program.get<bool>("--rect");
+    bool fullDecode = program.get<bool>("--full-decode");
+    std::string inputFormat = program.get<std::string>("--input-format");
+    bool tile = program.get<bool>("--tile");
+    float tileOverlap = program.get<float>("--tile-overlap");
+    std::string perfMode = program.get<std::string>("--perf-mode");
+    std::string numStreams = program.get<std::string>("--num-streams");
+    int numThreads = program.get<int>("--threads");
+    std::string cpuPinning = program.get<std::string>("--cpu-pinning");
+    std::string coreType = program.get<std::string>("--core-type");
+    std::string cacheDir = program.get<std::string>("--cache-dir");
+    bool compiledBlob = program.get<bool>("--compiled-blob");
+    bool graphNms = program.get<bool>("--graph-nms");
+    std::string nmsMethod = program.get<std::string>("--nms-method");
+    int graphTopK = program.get<int>("--graph-topk");
+    std::vector<std::string> classNames = program.get<std::vector<std::string>>("--classes");
+    bool graphMaxScore = program.get<bool>("--graph-max-score") || graphTopK > 0;
+    bool numa = program.get<bool>("--numa");
+    std::string numaDispatch = program.get<std::string>("--numa-dispatch");
+    int warmup = program.get<int>("--warmup");
+    bool watchModel = program.get<bool>("--watch-model");
+    bool hugePages = program.get<bool>("--huge-pages");
     std::vector<int> imgSize = program.get<std::vector<int>>("--imgsz");
     auto imgPath = program.present("-i");
     auto vidPath = program.present("-v");
@@ -88,6 +223,136 @@ Args parseArgs(int argc, char **argv)
     if (imgSize.size() == 1)
         imgSize.push_back(imgSize[0]);
 
+    if (numRequests < 0)
+    {
+        std::cerr << LogError("Invalid Value", "--nireq must not be negative!") << std::endl;
+        std::abort();
+    }
+
+    if (batchSize < 1)
+    {
+        std::cerr << LogError("Invalid Value", "--batch must be at least 1!") << std::endl;
+        std::abort();
+    }
+
+    if (vidPath && batchSize > 1)
+    {
+        std::cerr << LogError("Double Entry", "--batch only applies to image sources, video frames run one at a time (use --async to overlap them)!") << std::endl;
+        std::abort();
+    }
+
+    std::vector<std::string> backends = preprocessorNames();
+    if (std::find(backends.begin(), backends.end(), preprocess) == backends.end())
+    {
+        std::cerr << LogError("Invalid Value", "--preprocess must be one of kernel, opencv-nearest, opencv-linear, opencv-area or ppp!") << std::endl;
+        std::abort();
+    }
+
+    if (!(inputFormat == "bgr" || inputFormat == "nv12" || inputFormat == "i420"))
+    {
+        std::cerr << LogError("Invalid Value", "--input-format must be bgr, nv12 or i420!") << std::endl;
+        std::abort();
+    }
+
+    if (inputFormat != "bgr" && (async || batchSize != 1 || dynamicBatch || pppResize || rect || tile))
+    {
+        std::cerr << LogError("Double Entry", "--input-format nv12/i420 runs single frames and cannot be combined with --async, --batch, --dynamic-batch, --ppp-resize, --rect or --tile!") << std::endl;
+        std::abort();
+    }
+
+    if (pppResize && rect)
+    {
+        std::cerr << LogError("Double Entry", "Please specify either --ppp-resize or --rect!") << std::endl;
+        std::abort();
+    }
+
+    if (tile && (async || pppResize))
+    {
+        std::cerr << LogError("Double Entry", "--tile cannot be combined with --async or --ppp-resize!") << std::endl;
+        std::abort();
+    }
+
+    if (tileOverlap < 0.0f || tileOverlap >= 1.0f)
+    {
+        std::cerr << LogError("Invalid Value", "--tile-overlap must be in [0, 1)!") << std::endl;
+        std::abort();
+    }
+
+    std::vector<int> classes;
+    for (const auto& name : classNames)
+    {
+        int id = -1;
+        auto label = std::find(COCO_LABELS.begin(), COCO_LABELS.end(), name);
+        if (label != COCO_LABELS.end())
+            id = static_cast<int>(label - COCO_LABELS.begin());
+        else if (!name.empty() && name.size() < 4 && std::all_of(name.begin(), name.end(), [](unsigned char c) { return std::isdigit(c); }))
+            id = std::stoi(name);
+
+        if (id < 0 || id >= static_cast<int>(COCO_LABELS.size()))
+        {
+            std::cerr << LogError("Invalid Value", "--classes got unknown class " + name + "!") << std::endl;
+            std::abort();
+        }
+        if (std::find(classes.begin(), classes.end(), id) != classes.end())
+        {
+            std::cerr << LogError("Double Entry", "--classes lists " + name + " twice!") << std::endl;
+            std::abort();
+        }
+        classes.push_back(id);
+    }
+
+    if (graphTopK < 0)
+    {
+        std::cerr << LogError("Invalid Value", "--graph-topk must be >= 0!") << std::endl;
+        std::abort();
+    }
+
+    if (graphNms && graphMaxScore)
+    {
+        std::cerr << LogError("Double Entry", "Please specify either --graph-nms or --graph-max-score!") << std::endl;
+        std::abort();
+    }
+
+    if (!(nmsMethod == "sweep" || nmsMethod == "offset"))
+    {
+        std::cerr << LogError("Invalid Value", "--nms-method must be sweep or offset!") << std::endl;
+        std::abort();
+    }
+
+    if (!(numaDispatch == "round-robin" || numaDispatch == "least-load"))
+    {
+        std::cerr << LogError("Invalid Value", "--numa-dispatch must be round-robin or least-load!") << std::endl;
+        std::abort();
+    }
+
+    if (!(perfMode.empty() || perfMode == "LATENCY" || perfMode == "THROUGHPUT" || perfMode == "CUMULATIVE_THROUGHPUT"))
+    {
+        std::cerr << LogError("Invalid Value", "--perf-mode must be LATENCY, THROUGHPUT or CUMULATIVE_THROUGHPUT!") << std::endl;
+        std::abort();
+    }
+
+    if (!(numStreams.empty() || numStreams == "AUTO" || numStreams.find_first_not_of("0123456789") == std::string::npos))
+    {
+        std::cerr << LogError("Invalid Value", "--num-streams must be a number or AUTO!") << std::endl;
+        std::abort();
+    }
+
+    if (!(cpuPinning.empty() || cpuPinning == "on" || cpuPinning == "off"))
+    {
+        std::cerr << LogError("Invalid Value", "--cpu-pinning must be on or off!") << std::endl;
+        std::abort();
+    }
+
+    if (!(coreType.empty() || coreType == "ANY_CORE" || coreType == "PCORE_ONLY" || coreType == "ECORE_ONLY"))
+    {
+        std::cerr << LogError("Invalid Value", "--core-type must be ANY_CORE, PCORE_ONLY or ECORE_ONLY!") << std::endl;
+        std::abort();
+    }
+
+    // a single request is enough when frames are processed one at a time
+    if (!async)
+        numRequests = 1;
+
     Source type;
     std::string source;
 
@@ -105,16 +370,56 @@ Args parseArgs(int argc, char **argv)
         source = vidPath.value();
     }
 
-    Args args{modelPath, type, source, imgSize, useGPU, scoreThresh, iouThresh};
+    YoloNASConfig config;
+    config.imgSize = imgSize;
+    config.scoreThresh = scoreThresh;
+    config.iouThresh = iouThresh;
+    config.graphNms = graphNms;
+    config.nmsMethod = nmsMethod;
+    config.classes = classes;
+    config.graphMaxScore = graphMaxScore;
+    config.graphTopK = graphTopK;
+    config.batchSize = dynamicBatch ? 0 : batchSize;
+    config.preprocess = pppResize ? "ppp" : preprocess;
+    config.pppResize = pppResize;
+    config.rect = rect;
+    config.reducedDecode = !fullDecode;
+    config.inputFormat = inputFormat;
+    config.tile = tile;
+    config.tileOverlap = tileOverlap;
+    // tiles run as one batch unless a static batch size was asked for
+    if (tile && batchSize == 1)
+        config.batchSize = 0;
+    config.cacheDir = cacheDir;
+    config.compiledBlob = compiledBlob;
+    config.numa = numa;
+    config.numaDispatch = numaDispatch;
+    config.warmup = warmup;
+    config.watchModel = watchModel;
+    config.device.gpu = useGPU;
+    config.device.performanceMode = perfMode;
+    config.device.numStreams = numStreams;
+    config.device.numThreads = numThreads;
+    config.device.cpuPinning = cpuPinning.empty() ? -1 : (cpuPinning == "on" ? 1 : 0);
+    config.device.schedulingCoreType = coreType;
+    config.device.numRequests = numRequests;
+
+    Args args{modelPath, type, source, async, batchSize, config, hugePages};
 
     std::string emoji = args.type == IMAGE ? "🖼️" : "📷";
     std::cout << emoji + LogInfo(" Detect", "model=" + args.modelPath);
     std::cout << " source=" + args.source;
     std::cout << " imgsz="
-              << "[" << args.imgSize[0] << "," << args.imgSize[1] << "]";
-    std::cout << " device=" << (args.gpu ? "true" : "false");
-    std::cout << " score-tresh=" << args.scoreThresh;
-    std::cout << " iou-thresh=" << args.iouThresh << std::endl;
+              << "[" << config.imgSize[0] << "," << config.imgSize[1] << "]";
+    std::cout << " device=" << (config.device.gpu ? "true" : "false");
+    std::cout << " score-tresh=" << config.scoreThresh;
+    std::cout << " iou-thresh=" << config.iouThresh;
+    std::cout << " async=" << (args.async ? "true" : "false");
+    std::cout << " batch=" << args.batchSize << (dynamicBatch ? " (dynamic)" : "");
+    std::cout << " preprocess=" << config.preprocess;
+    std::cout << " input-format=" << config.inputFormat;
+    std::cout << " rect=" << (config.rect ? "true" : "false");
+    std::cout << " tile=" << (config.tile ? "true" : "false") << std::endl;
 
     return args;
 }
\ No newline at end of file
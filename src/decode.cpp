@@ -0,0 +1,100 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <fstream>
+
+#include "decode.hpp"
+
+cv::Size jpegSize(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    auto next = [&file]() { return file.get(); };
+    auto word = [&next]() {
+        int high = next();
+        int low = next();
+        return (high << 8) | low;
+    };
+
+    if (next() != 0xFF || next() != 0xD8)
+        return cv::Size();
+
+    while (file) {
+        // markers may be preceded by any number of 0xFF fill bytes
+        int marker = next();
+        if (marker != 0xFF)
+            return cv::Size();
+        while (marker == 0xFF)
+            marker = next();
+
+        // standalone markers carry no length
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+            continue;
+        if (marker == 0xD9 || marker == 0xDA || marker < 0)
+            return cv::Size();
+
+        int length = word();
+        if (length < 2)
+            return cv::Size();
+
+        // SOF0-SOF15, except DHT, JPG and DAC which share the range
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            next(); // precision
+            int height = word();
+            int width = word();
+            if (!file || width <= 0 || height <= 0)
+                return cv::Size();
+            return cv::Size(width, height);
+        }
+
+        file.seekg(length - 2, std::ios::cur);
+    }
+
+    return cv::Size();
+}
+
+int reducedDecodeFactor(cv::Size image, cv::Size needed)
+{
+    // libjpeg rounds the scaled size up
+    for (int factor = 8; factor > 1; factor /= 2) {
+        int width = (image.width + factor - 1) / factor;
+        int height = (image.height + factor - 1) / factor;
+        if (width >= needed.width && height >= needed.height)
+            return factor;
+    }
+    return 1;
+}
+
+int reducedReadFlag(int factor)
+{
+    switch (factor) {
+    case 2:
+        return cv::IMREAD_REDUCED_COLOR_2;
+    case 4:
+        return cv::IMREAD_REDUCED_COLOR_4;
+    case 8:
+        return cv::IMREAD_REDUCED_COLOR_8;
+    default:
+        return cv::IMREAD_COLOR;
+    }
+}
\ No newline at end of file
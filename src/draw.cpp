@@ -27,25 +27,24 @@ SOFTWARE.
 #include "utils.hpp"
 #include "draw.hpp"
 
-void drawBoxes(cv::Mat& image, const std::vector<std::vector<Box>>& boxes, float width_ratio, float height_ratio) {
-    Colors colorPalette;
-
-    for (const auto& box_list : boxes) {
-        for (const auto& box : box_list) {
-            float x1 = box.x1 * width_ratio;
-            float y1 = box.y1 * height_ratio;
-            float x2 = box.x2 * width_ratio;
-            float y2 = box.y2 * height_ratio;
-
-            cv::Scalar color = colorPalette.get(static_cast<int>(box.class_id)); // Get the color for the class from the palette
-
-            cv::rectangle(image, cv::Point_<float>(x1, y1), cv::Point_<float>(x2, y2), color, 2);
-
-            std::string label = "Class: " + std::to_string(static_cast<int>(box.class_id)) + ", Confidence: " + std::to_string(box.confidence);
-            int baseline = 0;
-            cv::Size textSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
-            cv::rectangle(image, cv::Point_<float>(x1, y1 - textSize.height - 5), cv::Point_<float>(x1 + textSize.width, y1), color, cv::FILLED);
-            cv::putText(image, label, cv::Point_<float>(x1, y1 - 5), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1);
-        }
-    } 
+void drawBoxes(cv::Mat& image, const std::vector<Box>& boxes, float width_ratio, float height_ratio) {
+    // built once instead of on every frame
+    static const Colors colorPalette;
+
+    for (const auto& box : boxes) {
+        float x1 = box.x1 * width_ratio;
+        float y1 = box.y1 * height_ratio;
+        float x2 = box.x2 * width_ratio;
+        float y2 = box.y2 * height_ratio;
+
+        cv::Scalar color = colorPalette.get(static_cast<int>(box.class_id)); // Get the color for the class from the palette
+
+        cv::rectangle(image, cv::Point_<float>(x1, y1), cv::Point_<float>(x2, y2), color, 2);
+
+        std::string label = "Class: " + std::to_string(static_cast<int>(box.class_id)) + ", Confidence: " + std::to_string(box.confidence);
+        int baseline = 0;
+        cv::Size textSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
+        cv::rectangle(image, cv::Point_<float>(x1, y1 - textSize.height - 5), cv::Point_<float>(x1 + textSize.width, y1), color, cv::FILLED);
+        cv::putText(image, label, cv::Point_<float>(x1, y1 - 5), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "frame-pool.hpp"
+
+static constexpr size_t frameAlignment = 64;
+static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+FramePool::FramePool(size_t count, bool hugePages)
+    : count(count), hugePages(hugePages), used(count, false)
+{
+}
+
+FramePool::~FramePool()
+{
+    if (!arena)
+        return;
+
+#ifdef __linux__
+    munmap(arena, arenaBytes);
+#elif defined(_WIN32)
+    _aligned_free(arena);
+#else
+    std::free(arena);
+#endif
+}
+
+void FramePool::allocate(size_t bytes)
+{
+    slotBytes = (bytes + frameAlignment - 1) / frameAlignment * frameAlignment;
+    arenaBytes = slotBytes * count;
+
+#ifdef __linux__
+    // anonymous mappings are page aligned, rounding up to whole huge pages
+    // lets the kernel back all of it with them
+    if (hugePages)
+        arenaBytes = (arenaBytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+    void* memory = mmap(nullptr, arenaBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (hugePages)
+        madvise(memory, arenaBytes, MADV_HUGEPAGE);
+#endif
+#elif defined(_WIN32)
+    void* memory = _aligned_malloc(arenaBytes, frameAlignment);
+    if (!memory)
+        throw std::bad_alloc();
+#else
+    void* memory = std::aligned_alloc(frameAlignment, arenaBytes);
+    if (!memory)
+        throw std::bad_alloc();
+#endif
+
+    arena = static_cast<unsigned char*>(memory);
+}
+
+cv::Mat FramePool::acquire(cv::Size size, int type)
+{
+    size_t bytes = static_cast<size_t>(size.area()) * CV_ELEM_SIZE(type);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!arena && count > 0 && bytes > 0)
+        allocate(bytes);
+
+    if (bytes <= slotBytes) {
+        for (size_t i = 0; i < count; i++) {
+            if (!used[i]) {
+                used[i] = true;
+                return cv::Mat(size, type, arena + i * slotBytes);
+            }
+        }
+    }
+
+    return cv::Mat(size, type);
+}
+
+void FramePool::release(const cv::Mat& frame)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!arena || frame.data < arena || frame.data >= arena + slotBytes * count)
+        return;
+
+    used[static_cast<size_t>(frame.data - arena) / slotBytes] = false;
+}
+
+size_t FramePool::size() const
+{
+    return count;
+}
+
+size_t FramePool::busy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t busy = 0;
+    for (bool slot : used)
+        busy += slot ? 1 : 0;
+    return busy;
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "infer-pool.hpp"
+
+InferencePool::InferencePool(const ov::CompiledModel& compiledModel, size_t size)
+    : compiled(compiledModel), slots(size)
+{
+    for (size_t id = 0; id < slots.size(); id++) {
+        slots[id].request = compiled.create_infer_request();
+        slots[id].request.set_callback([this, id](std::exception_ptr error) {
+            // notify under the lock, the destructor may run as soon as it is
+            // released and take cv with it
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[id].running = false;
+            slots[id].error = error;
+            cv.notify_all();
+        });
+    }
+}
+
+InferencePool::~InferencePool()
+{
+    // callbacks capture this pool, so wait for every request still in flight
+    for (auto& slot : slots) {
+        try {
+            slot.request.wait();
+        }
+        catch (...) {
+            // the error belongs to a frame nobody collects anymore
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] {
+        for (const auto& slot : slots) {
+            if (slot.running)
+                return false;
+        }
+        return true;
+    });
+}
+
+size_t InferencePool::size() const
+{
+    return slots.size();
+}
+
+size_t InferencePool::busy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& slot : slots) {
+        if (slot.busy)
+            count++;
+    }
+    return count;
+}
+
+ov::CompiledModel& InferencePool::compiledModel()
+{
+    return compiled;
+}
+
+size_t InferencePool::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t id = 0;
+    cv.wait(lock, [this, &id] {
+        for (id = 0; id < slots.size(); id++) {
+            if (!slots[id].busy)
+                return true;
+        }
+        return false;
+    });
+    slots[id].busy = true;
+    return id;
+}
+
+bool InferencePool::tryAcquire(size_t& id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (id = 0; id < slots.size(); id++) {
+        if (!slots[id].busy) {
+            slots[id].busy = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void InferencePool::release(size_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[id].busy = false;
+    }
+    cv.notify_all();
+}
+
+ov::InferRequest& InferencePool::request(size_t id)
+{
+    return slots[id].request;
+}
+
+void InferencePool::start(size_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[id].running = true;
+        slots[id].error = nullptr;
+    }
+    try {
+        slots[id].request.start_async();
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[id].running = false;
+        }
+        cv.notify_all();
+        throw;
+    }
+}
+
+void InferencePool::wait(size_t id)
+{
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this, id] { return !slots[id].running; });
+        error = slots[id].error;
+        slots[id].error = nullptr;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
\ No newline at end of file
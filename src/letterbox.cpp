@@ -0,0 +1,154 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "cpu-features.hpp"
+
+#if YOLO_NAS_SIMD
+#include <immintrin.h>
+#endif
+
+#include "letterbox.hpp"
+
+// Source column of every output column, same rounding as cv::INTER_NEAREST
+static void columnOffsets(std::vector<int32_t>& offsets, int srcWidth, int contentWidth)
+{
+    double scale = (double)srcWidth / (double)contentWidth;
+    offsets.resize(contentWidth);
+    for (int x = 0; x < contentWidth; x++)
+        offsets[x] = std::min((int)std::floor(x * scale), srcWidth - 1) * 3;
+}
+
+// Copies the pixels of one output row, from column x on
+static void copyRowScalar(const uint8_t* srcRow, uint8_t* dstRow, const int32_t* offsets, int x, int width, bool swapRB)
+{
+    int first = swapRB ? 2 : 0;
+    int last = swapRB ? 0 : 2;
+    for (; x < width; x++) {
+        const uint8_t* pixel = srcRow + offsets[x];
+        uint8_t* out = dstRow + x * 3;
+        out[0] = pixel[first];
+        out[1] = pixel[1];
+        out[2] = pixel[last];
+    }
+}
+
+#if YOLO_NAS_SIMD
+
+// 16 pixels per step: gather one 32-bit word per pixel, keep 3 bytes of each
+// and compact the 4 lanes into 48 contiguous bytes
+YOLO_NAS_TARGET_AVX512 static int copyRowAvx512(const uint8_t* srcRow, uint8_t* dstRow, const int32_t* offsets, int width, bool swapRB)
+{
+    const __m512i pack = swapRB
+        ? _mm512_broadcast_i32x4(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1))
+        : _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1));
+    const __m512i compact = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15);
+    const __mmask64 mask = (1ULL << 48) - 1;
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m512i index = _mm512_loadu_si512(offsets + x);
+        __m512i pixels = _mm512_i32gather_epi32(index, srcRow, 1);
+        pixels = _mm512_permutexvar_epi32(compact, _mm512_shuffle_epi8(pixels, pack));
+        _mm512_mask_storeu_epi8(dstRow + x * 3, mask, pixels);
+    }
+    return x;
+}
+
+// 8 pixels per step: gather one 32-bit word per pixel, keep 3 bytes of each
+// and compact the 2 lanes into 24 contiguous bytes
+YOLO_NAS_TARGET_AVX2 static int copyRowAvx2(const uint8_t* srcRow, uint8_t* dstRow, const int32_t* offsets, int width, bool swapRB)
+{
+    const __m256i pack = swapRB
+        ? _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+        : _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + x));
+        __m256i pixels = _mm256_i32gather_epi32(reinterpret_cast<const int*>(srcRow), index, 1);
+        pixels = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, pack), compact);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + x * 3), _mm256_castsi256_si128(pixels));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dstRow + x * 3 + 16), _mm256_extracti128_si256(pixels, 1));
+    }
+    return x;
+}
+
+#endif
+
+const char* letterboxKernel()
+{
+    return simdLevelName(simdLevel());
+}
+
+void letterboxNearest(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                      uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride,
+                      int contentWidth, int contentHeight, bool swapRB)
+{
+    contentWidth = std::max(0, std::min(contentWidth, dstWidth));
+    contentHeight = std::max(0, std::min(contentHeight, dstHeight));
+
+    // reused across calls, only reallocated when a wider image comes along
+    thread_local std::vector<int32_t> offsets;
+    columnOffsets(offsets, srcWidth, contentWidth);
+
+    // the gathers read 4 bytes per pixel, so the columns that map to the last
+    // source pixel are left to the scalar loop to stay inside the row
+    int simdWidth = contentWidth;
+    while (simdWidth > 0 && offsets[simdWidth - 1] + 4 > srcWidth * 3)
+        simdWidth--;
+
+    double scale = (double)srcHeight / (double)std::max(1, contentHeight);
+    size_t contentBytes = static_cast<size_t>(contentWidth) * 3;
+    size_t rowBytes = static_cast<size_t>(dstWidth) * 3;
+#if YOLO_NAS_SIMD
+    SimdLevel level = simdLevel();
+#endif
+
+    for (int y = 0; y < contentHeight; y++) {
+        int sy = std::min((int)std::floor(y * scale), srcHeight - 1);
+        const uint8_t* srcRow = src + sy * srcStride;
+        uint8_t* dstRow = dst + y * dstStride;
+
+        int x = 0;
+#if YOLO_NAS_SIMD
+        if (level == SimdLevel::AVX512)
+            x = copyRowAvx512(srcRow, dstRow, offsets.data(), simdWidth, swapRB);
+        else if (level == SimdLevel::AVX2)
+            x = copyRowAvx2(srcRow, dstRow, offsets.data(), simdWidth, swapRB);
+#endif
+        copyRowScalar(srcRow, dstRow, offsets.data(), x, contentWidth, swapRB);
+
+        if (contentBytes < rowBytes)
+            std::memset(dstRow + contentBytes, 0, rowBytes - contentBytes);
+    }
+
+    for (int y = contentHeight; y < dstHeight; y++)
+        std::memset(dst + y * dstStride, 0, rowBytes);
+}
\ No newline at end of file
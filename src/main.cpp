@@ -23,44 +23,170 @@ SOFTWARE.
 */
 
 #include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <csignal>
 
 #include "cli.hpp"
 #include "yolo-nas.hpp"
+#include "draw.hpp"
+#include "frame-pool.hpp"
 
 #include <chrono>
 
-int predictImage(YoloNAS model, Args args) {
+#ifdef YOLO_NAS_COUNT_ALLOCATIONS
+#include "allocation-counter.hpp"
+#endif
 
-	cv::Mat img = cv::imread(args.source);
+// heap allocations of the detector calls since the last print; drawing,
+// decoding and the window are left out, they allocate on every frame
+static size_t frameAllocations = 0;
 
-	model.predict(img);
+#ifdef YOLO_NAS_COUNT_ALLOCATIONS
+using CountFrameAllocations = CountAllocations;
+
+static void printAllocations() {
+	std::cout << "Allocations = " << frameAllocations << "\t";
+	frameAllocations = 0;
+}
+#else
+struct CountFrameAllocations {
+	explicit CountFrameAllocations(size_t&) {}
+};
+
+static void printAllocations() {
+}
+#endif
+
+// set by SIGHUP, the video loops reload the model when they see it
+static volatile std::sig_atomic_t reloadRequested = 0;
+
+#ifdef SIGHUP
+static void requestReload(int) {
+	reloadRequested = 1;
+}
+#endif
+
+static void reloadIfRequested(YoloNAS& model) {
+	if (reloadRequested) {
+		reloadRequested = 0;
+		model.reload();
+	}
+}
+
+// OpenCV hands out BGR frames, so the YUV input modes are fed by converting
+// them here; a decoder producing YUV would pass its planes directly
+static std::vector<Box> detectYuv(YoloNAS& model, const cv::Mat& frame, const std::string& format) {
+	// 4:2:0 needs even sides
+	cv::Mat even = frame(cv::Rect(0, 0, frame.cols & ~1, frame.rows & ~1));
+	cv::Mat yuv;
+	cv::cvtColor(even, yuv, cv::COLOR_BGR2YUV_I420);
+
+	int width = even.cols;
+	int height = even.rows;
+	cv::Mat y = yuv.rowRange(0, height);
+	cv::Mat u(height / 2, width / 2, CV_8UC1, yuv.data + width * height);
+	cv::Mat v(height / 2, width / 2, CV_8UC1, yuv.data + width * height * 5 / 4);
+
+	if (format == "i420")
+		return model.detectI420(y, u, v);
+
+	cv::Mat uv;
+	cv::merge(std::vector<cv::Mat>{ u, v }, uv);
+	return model.detectNV12(y, uv);
+}
+
+int predictImage(YoloNAS& model, Args& args) {
+
+	std::vector<std::string> paths;
+	if (std::filesystem::is_directory(args.source)) {
+		for (const auto& entry : std::filesystem::directory_iterator(args.source)) {
+			if (entry.is_regular_file())
+				paths.push_back(entry.path().string());
+		}
+		std::sort(paths.begin(), paths.end());
+	}
+	else {
+		paths.push_back(args.source);
+	}
+
+	// decode and run one batch of images at a time
+	for (size_t begin = 0; begin < paths.size(); begin += args.batchSize) {
+		std::vector<std::string> names;
+		std::vector<cv::Mat> imgs;
+		std::vector<Ratios> ratios;
+		for (size_t i = begin; i < std::min(paths.size(), begin + args.batchSize); i++) {
+			Ratios ratio;
+			cv::Mat img = model.readImage(paths[i], ratio);
+			if (img.empty())
+				continue;
+			names.push_back(paths[i]);
+			imgs.push_back(img);
+			ratios.push_back(ratio);
+		}
+
+		if (imgs.empty())
+			continue;
+
+		std::vector<std::vector<Box>> results;
+		if (args.config.inputFormat == "bgr") {
+			results = model.detect(imgs);
+		}
+		else {
+			for (const auto& img : imgs)
+				results.push_back(detectYuv(model, img, args.config.inputFormat));
+		}
+
+		for (size_t i = 0; i < imgs.size(); i++) {
+			// boxes in original image coordinates, drawn onto the reduced decode
+			for (auto& box : results[i]) {
+				box.x1 *= ratios[i][0];
+				box.y1 *= ratios[i][1];
+				box.x2 *= ratios[i][0];
+				box.y2 *= ratios[i][1];
+			}
+			drawBoxes(imgs[i], results[i], 1.0f / ratios[i][0], 1.0f / ratios[i][1]);
+
+			cv::imshow(names[i], imgs[i]);
+			cv::waitKey(0);
+			cv::destroyWindow(names[i]);
+		}
+	}
 
-	cv::imshow(args.source, img);
-	cv::waitKey(0);
 	cv::destroyAllWindows();
 
 	return 0;
 }
 
-int predictVideo(YoloNAS model, Args args) {
+int predictVideo(YoloNAS& model, Args& args) {
 
 	cv::VideoCapture cap = cv::VideoCapture(args.source);
 	std::chrono::steady_clock::time_point begin;
 	std::chrono::steady_clock::time_point end;
 	float latency;
+	// read into the same buffer every time
+	cv::Mat frame;
+	std::vector<Box> boxes;
 
 	while (cap.isOpened()) {
-		cv::Mat frame;
-
 		cap >> frame;
+		reloadIfRequested(model);
 
 		if (!frame.empty()) {
 			begin = std::chrono::steady_clock::now();
-			model.predict(frame);
+			{
+				CountFrameAllocations counting(frameAllocations);
+				if (args.config.inputFormat == "bgr")
+					model.detect(frame, boxes);
+				else
+					boxes = detectYuv(model, frame, args.config.inputFormat);
+			}
+			drawBoxes(frame, boxes, 1.0f, 1.0f);
 			end = std::chrono::steady_clock::now();
 			cv::imshow(args.source, frame);
 
 			latency = static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+			printAllocations();
 			std::cout << "Latency = " << latency << "ms\t";
 			std::cout << "FPS = " << 1000.0 / latency << std::endl;
 
@@ -78,19 +204,102 @@ int predictVideo(YoloNAS model, Args args) {
 	return 0;
 }
 
+int predictVideoAsync(YoloNAS& model, Args& args) {
+
+	cv::VideoCapture cap = cv::VideoCapture(args.source);
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point end;
+	size_t frames = 0;
+	bool stop = false;
+	cv::Mat result;
+	std::vector<Box> boxes;
+
+	std::cout << "Infer requests = " << model.numRequests() << std::endl;
+
+	// one buffer per request in flight, plus the frame being read and the one shown
+	cv::Size frameSize(static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)), static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+	FramePool buffers(model.numRequests() + 2, args.hugePages);
+
+	auto show = [&]() {
+		drawBoxes(result, boxes, 1.0f, 1.0f);
+		frames++;
+		end = std::chrono::steady_clock::now();
+		cv::imshow(args.source, result);
+
+		float elapsed = static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+		printAllocations();
+		std::cout << "Frames = " << frames << "\t";
+		std::cout << "FPS = " << 1000.0 * frames / elapsed << std::endl;
+
+		if (cv::waitKey(1) == 27)
+			stop = true;
+		buffers.release(result);
+	};
+
+	while (cap.isOpened() && !stop) {
+		cv::Mat buffer = buffers.acquire(frameSize, CV_8UC3);
+		cv::Mat frame = buffer;
+
+		cap >> frame;
+
+		// the capture backend may hand out its own buffer instead
+		if (frame.data != buffer.data)
+			buffers.release(buffer);
+
+		if (frame.empty())
+			break;
+
+		reloadIfRequested(model);
+
+		// keep every request busy, collect the oldest frames once all are in
+		// flight; after a reload to fewer requests more frames than that may be
+		// pending, drain down to one less so submit() finds a free request
+		while (model.pending() >= model.numRequests()) {
+			{
+				CountFrameAllocations counting(frameAllocations);
+				model.retrieve(result, boxes);
+			}
+			show();
+		}
+
+		CountFrameAllocations counting(frameAllocations);
+		model.submit(frame);
+	}
+
+	while (model.retrieve(result, boxes)) {
+		if (!stop)
+			show();
+		else
+			buffers.release(result);
+	}
+
+	cap.release();
+	cv::destroyAllWindows();
+
+	return 0;
+}
+
 int main(int argc, char** argv)
 {
 
 	Args args = parseArgs(argc, argv);
 
-	YoloNAS model(args.modelPath, args.imgSize, args.gpu, args.scoreThresh, args.iouThresh);
+#ifdef SIGHUP
+	std::signal(SIGHUP, requestReload);
+#endif
+
+	YoloNAS model(args.modelPath, args.config);
+	model.printProperties();
 
 	if (args.type == IMAGE) {
 		predictImage(model, args);
 	}
 
 	else  if (args.type == VIDEO) {
-		predictVideo(model, args);
+		if (args.async)
+			predictVideoAsync(model, args);
+		else
+			predictVideo(model, args);
 	}
 
 	return 0;
@@ -0,0 +1,228 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "cpu-features.hpp"
+
+#if YOLO_NAS_SIMD
+#include <immintrin.h>
+#endif
+
+#include "box-store.hpp"
+#include "nms.hpp"
+#include "processing.hpp"
+
+const char* nmsKernel()
+{
+    return simdLevelName(simdLevel());
+}
+
+// Flags every box in [begin, end) of the same class as the pivot whose IoU
+// with it is above the threshold. Flagging boxes that were already decided,
+// the pivot included, has no effect, so there is no branch in the loop.
+// The vector versions below finish their tail with it.
+static void suppressOverlapsScalar(const BoxStore& store, size_t pivot, size_t k, size_t end, float threshold, int32_t* suppressed)
+{
+    const float px1 = store.x1[pivot], py1 = store.y1[pivot], px2 = store.x2[pivot], py2 = store.y2[pivot];
+    const float parea = store.area[pivot];
+    const int32_t pclass = store.class_id[pivot];
+
+    for (; k < end; k++) {
+        float w = std::max(0.0f, std::min(px2, store.x2[k]) - std::max(px1, store.x1[k]));
+        float h = std::max(0.0f, std::min(py2, store.y2[k]) - std::max(py1, store.y1[k]));
+        float overlap = w * h;
+        float iou = overlap / (parea + store.area[k] - overlap);
+        if (iou > threshold && store.class_id[k] == pclass)
+            suppressed[k] = -1;
+    }
+}
+
+#if YOLO_NAS_SIMD
+
+YOLO_NAS_TARGET_AVX512 static void suppressOverlapsAvx512(const BoxStore& store, size_t pivot, size_t begin, size_t end, float threshold, int32_t* suppressed)
+{
+    const __m512 vx1 = _mm512_set1_ps(store.x1[pivot]), vy1 = _mm512_set1_ps(store.y1[pivot]);
+    const __m512 vx2 = _mm512_set1_ps(store.x2[pivot]), vy2 = _mm512_set1_ps(store.y2[pivot]);
+    const __m512 varea = _mm512_set1_ps(store.area[pivot]), vthreshold = _mm512_set1_ps(threshold), zero = _mm512_setzero_ps();
+    const __m512i vclass = _mm512_set1_epi32(store.class_id[pivot]), ones = _mm512_set1_epi32(-1);
+    size_t k = begin;
+    for (; k + 16 <= end; k += 16) {
+        __m512 w = _mm512_max_ps(zero, _mm512_sub_ps(_mm512_min_ps(vx2, _mm512_loadu_ps(&store.x2[k])), _mm512_max_ps(vx1, _mm512_loadu_ps(&store.x1[k]))));
+        __m512 h = _mm512_max_ps(zero, _mm512_sub_ps(_mm512_min_ps(vy2, _mm512_loadu_ps(&store.y2[k])), _mm512_max_ps(vy1, _mm512_loadu_ps(&store.y1[k]))));
+        __m512 overlap = _mm512_mul_ps(w, h);
+        __m512 iou = _mm512_div_ps(overlap, _mm512_sub_ps(_mm512_add_ps(varea, _mm512_loadu_ps(&store.area[k])), overlap));
+        __mmask16 mask = _mm512_cmp_ps_mask(iou, vthreshold, _CMP_GT_OQ)
+                         & _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(&store.class_id[k]), vclass);
+        _mm512_mask_storeu_epi32(suppressed + k, mask, ones);
+    }
+    suppressOverlapsScalar(store, pivot, k, end, threshold, suppressed);
+}
+
+YOLO_NAS_TARGET_AVX2 static void suppressOverlapsAvx2(const BoxStore& store, size_t pivot, size_t begin, size_t end, float threshold, int32_t* suppressed)
+{
+    const __m256 vx1 = _mm256_set1_ps(store.x1[pivot]), vy1 = _mm256_set1_ps(store.y1[pivot]);
+    const __m256 vx2 = _mm256_set1_ps(store.x2[pivot]), vy2 = _mm256_set1_ps(store.y2[pivot]);
+    const __m256 varea = _mm256_set1_ps(store.area[pivot]), vthreshold = _mm256_set1_ps(threshold), zero = _mm256_setzero_ps();
+    const __m256i vclass = _mm256_set1_epi32(store.class_id[pivot]);
+    size_t k = begin;
+    for (; k + 8 <= end; k += 8) {
+        __m256 w = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vx2, _mm256_loadu_ps(&store.x2[k])), _mm256_max_ps(vx1, _mm256_loadu_ps(&store.x1[k]))));
+        __m256 h = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vy2, _mm256_loadu_ps(&store.y2[k])), _mm256_max_ps(vy1, _mm256_loadu_ps(&store.y1[k]))));
+        __m256 overlap = _mm256_mul_ps(w, h);
+        __m256 iou = _mm256_div_ps(overlap, _mm256_sub_ps(_mm256_add_ps(varea, _mm256_loadu_ps(&store.area[k])), overlap));
+        __m256i mask = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(iou, vthreshold, _CMP_GT_OQ)),
+                                        _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&store.class_id[k])), vclass));
+        __m256i* flags = reinterpret_cast<__m256i*>(suppressed + k);
+        _mm256_storeu_si256(flags, _mm256_or_si256(_mm256_loadu_si256(flags), mask));
+    }
+    suppressOverlapsScalar(store, pivot, k, end, threshold, suppressed);
+}
+
+#endif
+
+using SuppressOverlaps = void (*)(const BoxStore&, size_t, size_t, size_t, float, int32_t*);
+
+static SuppressOverlaps suppressOverlapsKernel()
+{
+#if YOLO_NAS_SIMD
+    switch (simdLevel()) {
+    case SimdLevel::AVX512:
+        return suppressOverlapsAvx512;
+    case SimdLevel::AVX2:
+        return suppressOverlapsAvx2;
+    default:
+        break;
+    }
+#endif
+    return suppressOverlapsScalar;
+}
+
+// Greedy NMS over the boxes at members, given in score order. They are
+// stored sorted by key, x1 + class_id * shift, so the boxes that can overlap
+// a kept box form the contiguous window [key - widest box, key + width) of
+// the store. The store keeps the original coordinates for the IoU.
+static void sweep(const std::vector<Box>& boxes, const std::vector<size_t>& members, double shift, float iouThreshold, NmsWorkspace& workspace)
+{
+    size_t count = members.size();
+    // in double, a float x1 shifted by 80 classes of a large image loses
+    // the fraction of a pixel the window bounds depend on
+    auto left = [&](size_t rank) {
+        const Box& box = boxes[members[rank]];
+        return box.x1 + box.class_id * shift;
+    };
+
+    auto& byX = workspace.byX;
+    byX.resize(count);
+    std::iota(byX.begin(), byX.end(), 0);
+    // ties in rank order, like a stable sort but without its buffer
+    std::sort(byX.begin(), byX.end(), [&left](size_t a, size_t b) {
+        double la = left(a), lb = left(b);
+        return la < lb || (la == lb && a < b);
+    });
+
+    BoxStore& store = workspace.store;
+    store.clear();
+    auto& key = workspace.key;
+    key.resize(count);
+    auto& position = workspace.position;
+    position.resize(count);
+    double widest = 0.0;
+    for (size_t k = 0; k < count; k++) {
+        const Box& box = boxes[members[byX[k]]];
+        store.push_back(box.x1, box.y1, box.x2, box.y2, static_cast<int32_t>(box.class_id), members[byX[k]]);
+        key[k] = left(byX[k]);
+        position[byX[k]] = k;
+        widest = std::max(widest, static_cast<double>(box.x2) - box.x1);
+    }
+
+    auto& suppressed = workspace.suppressed;
+    suppressed.assign(count, 0);
+    SuppressOverlaps suppressOverlaps = suppressOverlapsKernel();
+    for (size_t rank = 0; rank < count; rank++) {
+        size_t k = position[rank];
+        if (suppressed[k])
+            continue;
+        workspace.keep[store.index[k]] = 1;
+
+        double width = static_cast<double>(store.x2[k]) - store.x1[k];
+        size_t begin = std::lower_bound(key.begin(), key.end(), key[k] - widest) - key.begin();
+        size_t end = std::lower_bound(key.begin(), key.end(), key[k] + width) - key.begin();
+        suppressOverlaps(store, k, begin, end, iouThreshold, suppressed.data());
+    }
+}
+
+void nonMaxSuppression(const std::vector<Box>& boxes, float iouThreshold, NmsMethod method, NmsWorkspace& workspace, std::vector<size_t>& kept)
+{
+    workspace.keep.assign(boxes.size(), 0);
+    auto& members = workspace.members;
+
+    if (method == NmsMethod::Offset) {
+        float largest = 0.0f;
+        for (const auto& box : boxes)
+            largest = std::max({ largest, std::abs(box.x1), std::abs(box.x2) });
+
+        // only the sort key is shifted: boxes of different classes are apart
+        // in key (pruned by the sweep), and the class test of the IoU loop
+        // covers the few at the edges
+        members.resize(boxes.size());
+        std::iota(members.begin(), members.end(), 0);
+        sweep(boxes, members, largest + 1.0, iouThreshold, workspace);
+    }
+    else {
+        // bucket by class, score order is kept inside every bucket
+        auto& byClass = workspace.byClass;
+        byClass.resize(boxes.size());
+        std::iota(byClass.begin(), byClass.end(), 0);
+        std::sort(byClass.begin(), byClass.end(), [&boxes](size_t a, size_t b) {
+            return boxes[a].class_id < boxes[b].class_id || (boxes[a].class_id == boxes[b].class_id && a < b);
+        });
+
+        for (size_t begin = 0; begin < byClass.size();) {
+            float class_id = boxes[byClass[begin]].class_id;
+            size_t end = begin;
+            while (end < byClass.size() && boxes[byClass[end]].class_id == class_id)
+                end++;
+            members.assign(byClass.begin() + begin, byClass.begin() + end);
+            sweep(boxes, members, 0.0, iouThreshold, workspace);
+            begin = end;
+        }
+    }
+
+    kept.clear();
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (workspace.keep[i])
+            kept.push_back(i);
+    }
+}
+
+std::vector<size_t> nonMaxSuppression(const std::vector<Box>& boxes, float iouThreshold, NmsMethod method)
+{
+    NmsWorkspace workspace;
+    std::vector<size_t> kept;
+    nonMaxSuppression(boxes, iouThreshold, method, workspace, kept);
+    return kept;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdexcept>
+
+#include "preprocess.hpp"
+#include "letterbox.hpp"
+
+static void padContent(cv::Mat& dst, cv::Size content)
+{
+    if (content.width < dst.cols)
+        dst(cv::Rect(content.width, 0, dst.cols - content.width, dst.rows)).setTo(cv::Scalar::all(0));
+    if (content.height < dst.rows)
+        dst(cv::Rect(0, content.height, content.width, dst.rows - content.height)).setTo(cv::Scalar::all(0));
+}
+
+OpenCVPreprocessor::OpenCVPreprocessor(int interpolation)
+    : interpolation(interpolation)
+{
+}
+
+std::string OpenCVPreprocessor::name() const
+{
+    switch (interpolation) {
+    case cv::INTER_NEAREST:
+        return "opencv-nearest";
+    case cv::INTER_LINEAR:
+        return "opencv-linear";
+    case cv::INTER_AREA:
+        return "opencv-area";
+    default:
+        return "opencv";
+    }
+}
+
+void OpenCVPreprocessor::resize(const cv::Mat& source, cv::Mat& dst, cv::Size content) const
+{
+    cv::Mat roi = dst(cv::Rect(0, 0, content.width, content.height));
+    cv::resize(source, roi, content, 0, 0, interpolation);
+    padContent(dst, content);
+}
+
+std::string KernelPreprocessor::name() const
+{
+    return "kernel";
+}
+
+void KernelPreprocessor::resize(const cv::Mat& source, cv::Mat& dst, cv::Size content) const
+{
+    if (source.type() != CV_8UC3 || dst.type() != CV_8UC3) {
+        OpenCVPreprocessor(cv::INTER_NEAREST).resize(source, dst, content);
+        return;
+    }
+
+    letterboxNearest(source.data, source.cols, source.rows, source.step, dst.data, dst.cols, dst.rows, dst.step, content.width, content.height);
+}
+
+OpenVINOPreprocessor::OpenVINOPreprocessor()
+    : OpenCVPreprocessor(cv::INTER_LINEAR)
+{
+}
+
+std::string OpenVINOPreprocessor::name() const
+{
+    return "ppp";
+}
+
+std::vector<std::string> preprocessorNames()
+{
+    return { "kernel", "opencv-nearest", "opencv-linear", "opencv-area", "ppp" };
+}
+
+std::unique_ptr<Preprocessor> createPreprocessor(const std::string& name)
+{
+    if (name == "kernel")
+        return std::make_unique<KernelPreprocessor>();
+    if (name == "opencv-nearest")
+        return std::make_unique<OpenCVPreprocessor>(cv::INTER_NEAREST);
+    if (name == "opencv-linear")
+        return std::make_unique<OpenCVPreprocessor>(cv::INTER_LINEAR);
+    if (name == "opencv-area")
+        return std::make_unique<OpenCVPreprocessor>(cv::INTER_AREA);
+    if (name == "ppp")
+        return std::make_unique<OpenVINOPreprocessor>();
+
+    throw std::invalid_argument("unknown preprocessing backend " + name);
+}
\ No newline at end of file
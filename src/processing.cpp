@@ -22,129 +22,127 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+
 #include "processing.hpp"
 
-PPYoloEPostPredictionCallback::PPYoloEPostPredictionCallback(float score_threshold, float nms_threshold, int nms_top_k, int max_predictions, bool multi_label_per_box)
-    : score_threshold(score_threshold), nms_threshold(nms_threshold), nms_top_k(nms_top_k), max_predictions(max_predictions), multi_label_per_box(multi_label_per_box) {}
-
-std::vector<std::vector<Box>> PPYoloEPostPredictionCallback::forward(float* pred_bboxes, float* pred_scores, ov::Shape output_shape_bboxes, ov::Shape output_shape_scores) {
-    std::vector<std::vector<Box>> nms_result;
-
-    std::vector<Box> filtered_boxes;
-
-    // Filter all predictions by self.score_threshold
-    // TODO: Add multi_label support
-    if (multi_label_per_box) {
-        for (size_t i = 0; i < output_shape_scores.at(1); i++) {
-            for (size_t j = 0; j < output_shape_scores.at(2); j++) {
-                if (*(pred_scores + (i * output_shape_scores.at(1)) + j) > score_threshold) {
-                    Box box;
-                    auto bbox_begin = pred_bboxes + (i * output_shape_bboxes.at(2));
-                    box.x1 = *(bbox_begin);
-                    box.y1 = *(bbox_begin + 1);
-                    box.x2 = *(bbox_begin + 2);
-                    box.y2 = *(bbox_begin + 3);
-                    box.confidence = *(pred_scores + (i * output_shape_scores.at(1)) + j);
-                    box.class_id = static_cast<float>(j);
-                    filtered_boxes.push_back(box);
-                }
-            }
-        }
-    }
-    else {
-        for (size_t i = 0; i < output_shape_scores.at(1); i++) {
-            auto score_begin = pred_scores + (i * output_shape_scores.at(2));
-            auto score_end = score_begin + output_shape_scores.at(2);
-            auto max_el = std::max_element(score_begin, score_end);
-            float max_score = *max_el;
-            auto bbox_begin = pred_bboxes + (i * output_shape_bboxes.at(2));
-            size_t max_index = std::distance(score_begin, max_el);
-            if (max_score >= score_threshold) {
-                Box box;
-                box.x1 = *(bbox_begin);
-                box.y1 = *(bbox_begin + 1);
-                box.x2 = *(bbox_begin + 2);
-                box.y2 = *(bbox_begin + 3);
-                box.confidence = max_score;
-                box.class_id = static_cast<float>(max_index);
-                filtered_boxes.push_back(box);
-            }
+PPYoloEPostPredictionCallback::PPYoloEPostPredictionCallback(float score_threshold, float nms_threshold, int nms_top_k, int max_predictions, bool multi_label_per_box, NmsMethod nms_method, const std::vector<int>& class_ids)
+    : score_threshold(score_threshold), nms_threshold(nms_threshold), nms_top_k(nms_top_k), max_predictions(max_predictions), multi_label_per_box(multi_label_per_box), nms_method(nms_method),
+      class_ids(class_ids.begin(), class_ids.end()) {}
+
+void PPYoloEPostPredictionCallback::forward(const float* pred_bboxes, const float* pred_scores, size_t anchors, size_t classes, std::vector<Box>* results, size_t count) {
+    // one result per image, outputs are [N, anchors, 4] and [N, anchors, classes]
+    for (size_t b = 0; b < count; b++) {
+        results[b].clear();
+        forwardImage(pred_bboxes + b * anchors * 4, pred_scores + b * anchors * classes, anchors, classes, results[b]);
+        if (results[b].size() > static_cast<size_t>(max_predictions)) {
+            results[b].resize(max_predictions);
         }
     }
+}
 
-    // Sort predictions by confidence score
-    std::sort(filtered_boxes.begin(), filtered_boxes.end(), [](const Box& a, const Box& b) {
-        return a.confidence > b.confidence;
-        });
+std::vector<std::vector<Box>> PPYoloEPostPredictionCallback::forward(const float* pred_bboxes, const float* pred_scores, const ov::Shape& /*output_shape_bboxes*/, const ov::Shape& output_shape_scores) {
+    std::vector<std::vector<Box>> nms_result(output_shape_scores.at(0));
+    forward(pred_bboxes, pred_scores, output_shape_scores.at(1), output_shape_scores.at(2), nms_result.data(), nms_result.size());
+    return nms_result;
+}
 
-    // Filter all predictions by self.nms_top_k
-    if (filtered_boxes.size() > nms_top_k) {
-        filtered_boxes.resize(nms_top_k);
-    }
+void PPYoloEPostPredictionCallback::forwardBest(const float* pred_bboxes, const float* pred_best, size_t rows, std::vector<Box>* results, size_t count) {
+    for (size_t b = 0; b < count; b++) {
+        const float* best = pred_best + b * rows * 2;
 
-    // NMS
-    std::vector<float> scores;
-    std::vector<size_t> indices;
-    for (const auto& box : filtered_boxes) {
-        scores.push_back(box.confidence);
-        indices.push_back(static_cast<size_t>(box.class_id));
-    }
-    std::vector<size_t> idx_to_keep = performNMS(filtered_boxes, scores, indices, nms_threshold);
+        // same threshold as the single label scan
+        std::vector<Candidate>& candidates = workspace.candidates;
+        candidates.clear();
+        for (size_t i = 0; i < rows; i++) {
+            if (best[i * 2] >= score_threshold)
+                candidates.push_back({ best[i * 2], static_cast<uint32_t>(i), static_cast<uint32_t>(best[i * 2 + 1]) });
+        }
 
-    std::vector<Box> final_boxes;
-    for (const auto& idx : idx_to_keep) {
-        final_boxes.push_back(filtered_boxes[idx]);
+        results[b].clear();
+        forwardCandidates(pred_bboxes + b * rows * 4, results[b]);
+        if (results[b].size() > static_cast<size_t>(max_predictions)) {
+            results[b].resize(max_predictions);
+        }
     }
-    nms_result.push_back(final_boxes);
-
-    return _filter_max_predictions(nms_result);
 }
 
-std::vector<std::vector<Box>> PPYoloEPostPredictionCallback::_filter_max_predictions(std::vector<std::vector<Box>>& res) const {
-    for (auto& im : res) {
-        if (im.size() > max_predictions) {
-            im.resize(max_predictions);
+void PPYoloEPostPredictionCallback::forwardNms(const float* detections, const int32_t* counts, std::vector<Box>* results, size_t count) const {
+    for (size_t b = 0; b < count; b++) {
+        results[b].clear();
+        for (int32_t k = 0; k < counts[b]; k++) {
+            Box box;
+            box.x1 = detections[2];
+            box.y1 = detections[3];
+            box.x2 = detections[4];
+            box.y2 = detections[5];
+            box.confidence = detections[1];
+            box.class_id = class_ids.empty() ? detections[0] : class_ids[static_cast<size_t>(detections[0])];
+            results[b].push_back(box);
+            detections += 6;
         }
     }
-    return res;
 }
 
-std::vector<size_t> PPYoloEPostPredictionCallback::performNMS(const std::vector<Box>& boxes, const std::vector<float>& scores, const std::vector<size_t>& indices, float iou_threshold) const {
-    std::vector<size_t> keep;
-    std::vector<bool> suppressed(boxes.size(), false);
-
-    for (size_t i = 0; i < boxes.size(); i++) {
-        if (suppressed[i]) {
-            continue;
-        }
-
-        keep.push_back(i);
+std::vector<std::vector<Box>> PPYoloEPostPredictionCallback::forwardNms(const float* detections, const int32_t* counts, size_t batch) const {
+    std::vector<std::vector<Box>> nms_result(batch);
+    forwardNms(detections, counts, nms_result.data(), batch);
+    return nms_result;
+}
 
-        for (size_t j = i + 1; j < boxes.size(); j++) {
-            if (suppressed[j]) {
-                continue;
-            }
+void PPYoloEPostPredictionCallback::forwardImage(const float* pred_bboxes, const float* pred_scores, size_t anchors, size_t classes, std::vector<Box>& result) {
+    // Filter all predictions by self.score_threshold, scores are [anchors, classes]
+    std::vector<Candidate>& candidates = workspace.candidates;
+    candidates.clear();
+    if (multi_label_per_box)
+        scanAllScores(pred_scores, anchors, classes, score_threshold, candidates);
+    else
+        scanMaxScores(pred_scores, anchors, classes, score_threshold, candidates);
 
-            float intersection = calculateIntersection(boxes[i], boxes[j]);
-            float iou = intersection / (calculateArea(boxes[i]) + calculateArea(boxes[j]) - intersection);
+    forwardCandidates(pred_bboxes, result);
+}
 
-            if (iou > iou_threshold && indices[i] == indices[j]) {
-                suppressed[j] = true;
-            }
-        }
+void PPYoloEPostPredictionCallback::forwardCandidates(const float* pred_bboxes, std::vector<Box>& result) {
+    std::vector<Candidate>& candidates = workspace.candidates;
+
+    // Keep the nms_top_k best before materializing any box
+    selectTopK(candidates, static_cast<size_t>(std::max(nms_top_k, 0)));
+
+    std::vector<Box>& filtered_boxes = workspace.boxes;
+    filtered_boxes.clear();
+    for (const auto& candidate : candidates) {
+        Box box;
+        auto bbox_begin = pred_bboxes + (candidate.anchor * 4);
+        box.x1 = *(bbox_begin);
+        box.y1 = *(bbox_begin + 1);
+        box.x2 = *(bbox_begin + 2);
+        box.y2 = *(bbox_begin + 3);
+        box.confidence = candidate.score;
+        box.class_id = class_ids.empty() ? static_cast<float>(candidate.class_id) : class_ids[candidate.class_id];
+        filtered_boxes.push_back(box);
     }
 
-    return keep;
+    suppress(filtered_boxes, result);
 }
 
-float PPYoloEPostPredictionCallback::calculateIntersection(const Box& box1, const Box& box2) const {
-    float x1 = std::max(box1.x1, box2.x1);
-    float y1 = std::max(box1.y1, box2.y1);
-    float x2 = std::min(box1.x2, box2.x2);
-    float y2 = std::min(box1.y2, box2.y2);
-    return std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+std::vector<Box> PPYoloEPostPredictionCallback::merge(std::vector<Box> boxes) {
+    std::sort(boxes.begin(), boxes.end(), [](const Box& a, const Box& b) {
+        return a.confidence > b.confidence;
+        });
+
+    std::vector<Box> final_boxes;
+    suppress(boxes, final_boxes);
+    if (final_boxes.size() > static_cast<size_t>(max_predictions)) {
+        final_boxes.resize(max_predictions);
+    }
+    return final_boxes;
 }
 
-float PPYoloEPostPredictionCallback::calculateArea(const Box& box) const {
-    return (box.x2 - box.x1) * (box.y2 - box.y1);
+void PPYoloEPostPredictionCallback::suppress(const std::vector<Box>& boxes, std::vector<Box>& result) {
+    // class-aware NMS, only boxes of the same class that overlap in x are compared
+    nonMaxSuppression(boxes, nms_threshold, nms_method, workspace.nms, workspace.kept);
+
+    for (const auto& idx : workspace.kept) {
+        result.push_back(boxes[idx]);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+/*
+Licensed under the MIT License < http://opensource.org/licenses/MIT>.
+SPDX - License - Identifier : MIT
+Copyright(c) 2023 Mohammed Yasin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "cpu-features.hpp"
+
+#if YOLO_NAS_SIMD
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "score-scan.hpp"
+
+#if YOLO_NAS_SIMD
+// Index of the lowest set bit of a non-zero compare mask
+static inline size_t lowestBit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+const char* scoreScanKernel()
+{
+    return simdLevelName(simdLevel());
+}
+
+// Best score and its first class index for one anchor
+static inline void argmaxScalar(const float* row, size_t begin, size_t classes, float& best, size_t& index)
+{
+    for (size_t j = begin; j < classes; j++) {
+        if (row[j] > best) {
+            best = row[j];
+            index = j;
+        }
+    }
+}
+
+// First class from begin on whose score equals best
+static inline size_t firstEqual(const float* row, size_t begin, size_t classes, float best)
+{
+    for (size_t j = begin; j < classes; j++) {
+        if (row[j] == best)
+            return j;
+    }
+    return classes;
+}
+
+static void scanMaxScoresScalar(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    for (size_t i = 0; i < anchors; i++) {
+        const float* row = scores + i * classes;
+        float best = row[0];
+        size_t index = 0;
+        argmaxScalar(row, 1, classes, best, index);
+
+        if (best >= threshold)
+            out.push_back({ best, static_cast<uint32_t>(i), static_cast<uint32_t>(index) });
+    }
+}
+
+#if YOLO_NAS_SIMD
+
+// Needs at least 16 classes. Most anchors are rejected on the vector maximum
+// alone, the index is only looked up for the few that pass.
+YOLO_NAS_TARGET_AVX512 static void scanMaxScoresAvx512(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    size_t vectorEnd = classes / 16 * 16;
+    for (size_t i = 0; i < anchors; i++) {
+        const float* row = scores + i * classes;
+        __m512 maximum = _mm512_loadu_ps(row);
+        for (size_t j = 16; j < vectorEnd; j += 16)
+            maximum = _mm512_max_ps(maximum, _mm512_loadu_ps(row + j));
+        float best = _mm512_reduce_max_ps(maximum);
+        for (size_t j = vectorEnd; j < classes; j++)
+            best = row[j] > best ? row[j] : best;
+        if (!(best >= threshold))
+            continue;
+
+        __m512 target = _mm512_set1_ps(best);
+        size_t index = classes;
+        for (size_t j = 0; j < vectorEnd && index == classes; j += 16) {
+            __mmask16 equal = _mm512_cmp_ps_mask(_mm512_loadu_ps(row + j), target, _CMP_EQ_OQ);
+            if (equal)
+                index = j + lowestBit(equal);
+        }
+        if (index == classes)
+            index = firstEqual(row, vectorEnd, classes, best);
+
+        out.push_back({ best, static_cast<uint32_t>(i), static_cast<uint32_t>(index) });
+    }
+}
+
+// Needs at least 8 classes, same approach as the AVX-512 version
+YOLO_NAS_TARGET_AVX2 static void scanMaxScoresAvx2(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    size_t vectorEnd = classes / 8 * 8;
+    for (size_t i = 0; i < anchors; i++) {
+        const float* row = scores + i * classes;
+        __m256 maximum = _mm256_loadu_ps(row);
+        for (size_t j = 8; j < vectorEnd; j += 8)
+            maximum = _mm256_max_ps(maximum, _mm256_loadu_ps(row + j));
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(maximum), _mm256_extractf128_ps(maximum, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        float best = _mm_cvtss_f32(half);
+        for (size_t j = vectorEnd; j < classes; j++)
+            best = row[j] > best ? row[j] : best;
+        if (!(best >= threshold))
+            continue;
+
+        __m256 target = _mm256_set1_ps(best);
+        size_t index = classes;
+        for (size_t j = 0; j < vectorEnd && index == classes; j += 8) {
+            int equal = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row + j), target, _CMP_EQ_OQ));
+            if (equal)
+                index = j + lowestBit(equal);
+        }
+        if (index == classes)
+            index = firstEqual(row, vectorEnd, classes, best);
+
+        out.push_back({ best, static_cast<uint32_t>(i), static_cast<uint32_t>(index) });
+    }
+}
+
+#endif
+
+void scanMaxScores(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    if (classes == 0)
+        return;
+
+#if YOLO_NAS_SIMD
+    SimdLevel level = simdLevel();
+    if (level == SimdLevel::AVX512 && classes >= 16)
+        return scanMaxScoresAvx512(scores, anchors, classes, threshold, out);
+    if (level >= SimdLevel::AVX2 && classes >= 8)
+        return scanMaxScoresAvx2(scores, anchors, classes, threshold, out);
+#endif
+    scanMaxScoresScalar(scores, anchors, classes, threshold, out);
+}
+
+// Adds the score at a flat position of the [anchors x classes] tensor
+static inline void emitScore(const float* scores, size_t flat, size_t classes, std::vector<Candidate>& out)
+{
+    out.push_back({ scores[flat], static_cast<uint32_t>(flat / classes), static_cast<uint32_t>(flat % classes) });
+}
+
+#if YOLO_NAS_SIMD
+
+// Scans 16 scores per step, returns where the scalar tail starts
+YOLO_NAS_TARGET_AVX512 static size_t scanAllScoresAvx512(const float* scores, size_t total, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    __m512 limit = _mm512_set1_ps(threshold);
+    size_t k = 0;
+    for (; k + 16 <= total; k += 16) {
+        __mmask16 above = _mm512_cmp_ps_mask(_mm512_loadu_ps(scores + k), limit, _CMP_GT_OQ);
+        while (above) {
+            emitScore(scores, k + lowestBit(above), classes, out);
+            above &= above - 1;
+        }
+    }
+    return k;
+}
+
+// Scans 8 scores per step, returns where the scalar tail starts
+YOLO_NAS_TARGET_AVX2 static size_t scanAllScoresAvx2(const float* scores, size_t total, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    __m256 limit = _mm256_set1_ps(threshold);
+    size_t k = 0;
+    for (; k + 8 <= total; k += 8) {
+        int above = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(scores + k), limit, _CMP_GT_OQ));
+        while (above) {
+            emitScore(scores, k + lowestBit(above), classes, out);
+            above &= above - 1;
+        }
+    }
+    return k;
+}
+
+#endif
+
+void scanAllScores(const float* scores, size_t anchors, size_t classes, float threshold, std::vector<Candidate>& out)
+{
+    // the tensor is scanned as one flat array, anchor and class are only
+    // recovered for the scores that pass
+    size_t total = anchors * classes;
+    size_t k = 0;
+
+#if YOLO_NAS_SIMD
+    SimdLevel level = simdLevel();
+    if (level == SimdLevel::AVX512)
+        k = scanAllScoresAvx512(scores, total, classes, threshold, out);
+    else if (level == SimdLevel::AVX2)
+        k = scanAllScoresAvx2(scores, total, classes, threshold, out);
+#endif
+
+    for (; k < total; k++) {
+        if (scores[k] > threshold)
+            emitScore(scores, k, classes, out);
+    }
+}
+
+void selectTopK(std::vector<Candidate>& candidates, size_t k)
+{
+    auto better = [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score;
+    };
+
+    if (candidates.size() > k) {
+        std::nth_element(candidates.begin(), candidates.begin() + k, candidates.end(), better);
+        candidates.resize(k);
+    }
+    std::sort(candidates.begin(), candidates.end(), better);
+}
\ No newline at end of file
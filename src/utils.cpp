@@ -26,6 +26,10 @@ SOFTWARE.
 
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <cstring>
+
+#include "utils.hpp"
 
 std::string BCODE[] = {"\033[94m", "\033[93m", "\033[91m", "\033[0m", "\033[1m"};
 
@@ -61,4 +65,44 @@ void exists(std::string path)
         std::cerr << LogError("File Not Found", path) << std::endl;
         std::abort();
     }
+}
+
+static uint64_t fnv1a(const char* data, size_t size, uint64_t hash)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashString(const std::string& data, uint64_t seed)
+{
+    return fnv1a(data.data(), data.size(), seed);
+}
+
+uint64_t hashFile(const std::string& path, uint64_t seed)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+    uint64_t hash = seed;
+    while (file)
+    {
+        file.read(buffer.data(), buffer.size());
+        size_t size = static_cast<size_t>(file.gcount());
+
+        // FNV-1a over 8-byte words, a byte at a time is too slow for the
+        // weights of large models; only the last read has a tail
+        size_t words = size / 8;
+        for (size_t i = 0; i < words; i++)
+        {
+            uint64_t word;
+            std::memcpy(&word, buffer.data() + i * 8, 8);
+            hash ^= word;
+            hash *= 1099511628211ULL;
+        }
+        hash = fnv1a(buffer.data() + words * 8, size - words * 8, hash);
+    }
+    return hash;
 }
\ No newline at end of file
@@ -22,97 +22,1273 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <openvino/opsets/opset9.hpp>
+
 #include "processing.hpp"
 #include "yolo-nas.hpp"
 #include "utils.hpp"
 #include "draw.hpp"
+#include "numa.hpp"
+#include "preprocess.hpp"
+#include "decode.hpp"
 
 
-YoloNAS::YoloNAS(std::string modelPath, std::vector<int> imgsz, bool gpu, float score, float iou)
-    : postprocessor(score, iou, 1000, 300, false) // define postprocessor
+// Translates the device config into compile properties, unset fields are
+// left out so the plugin keeps its own defaults
+static ov::AnyMap compileProperties(const DeviceConfig& device, bool cpu)
+{
+    ov::AnyMap properties;
+
+    // more than one request in flight only pays off with the throughput hint
+    if (!device.performanceMode.empty())
+        properties.emplace(ov::hint::performance_mode.name(), device.performanceMode);
+    else if (device.numRequests != 1)
+        properties.emplace(ov::hint::performance_mode(ov::hint::PerformanceMode::THROUGHPUT));
+
+    if (device.numRequests > 1)
+        properties.emplace(ov::hint::num_requests(device.numRequests));
+    if (!device.numStreams.empty())
+        properties.emplace(ov::num_streams.name(), device.numStreams);
+
+    // threading properties are only understood by the CPU plugin, pinning and
+    // core type are passed by name so older runtimes still build
+    if (cpu) {
+        if (device.numThreads > 0)
+            properties.emplace(ov::inference_num_threads(device.numThreads));
+        if (device.cpuPinning >= 0)
+            properties.emplace("ENABLE_CPU_PINNING", device.cpuPinning == 1 ? "YES" : "NO");
+        if (!device.schedulingCoreType.empty())
+            properties.emplace("SCHEDULING_CORE_TYPE", device.schedulingCoreType);
+    }
+
+    return properties;
+}
+
+YoloNAS::YoloNAS(std::string modelPath, const YoloNASConfig& config)
+    : config(config),
+      modelPath(modelPath),
+      postprocessor(config.scoreThresh, config.iouThresh, config.nmsTopK, config.maxPredictions, config.multiLabel,
+                    config.nmsMethod == "offset" ? NmsMethod::Offset : NmsMethod::Sweep, config.classes) // define postprocessor
 {
     ov::Core core;
-    std::shared_ptr<ov::Model> model = core.read_model(modelPath);
+    if (!config.cacheDir.empty())
+        core.set_property(ov::cache_dir(config.cacheDir));
 
-    core.set_property(ov::cache_dir(".cache"));
+    if (std::any_of(config.classes.begin(), config.classes.end(), [](int id) { return id < 0; }))
+        throw std::invalid_argument("class ids must be >= 0");
+    std::vector<int> sortedClasses = config.classes;
+    std::sort(sortedClasses.begin(), sortedClasses.end());
+    if (std::adjacent_find(sortedClasses.begin(), sortedClasses.end()) != sortedClasses.end())
+        throw std::invalid_argument("class ids must not repeat");
+    if (config.graphMaxScore && config.multiLabel)
+        throw std::invalid_argument("graphMaxScore keeps one class per anchor and cannot be combined with multiLabel");
+    if (config.graphMaxScore && config.graphNms)
+        throw std::invalid_argument("graphMaxScore keeps host NMS and cannot be combined with graphNms");
 
-    imgSize = imgsz;
+    // --ppp-resize is the OpenVINO backend
+    preprocessor = createPreprocessor(config.pppResize ? "ppp" : config.preprocess);
+    this->config.pppResize = preprocessor->resizesInGraph();
+
+    // checked against the resolved backend, --preprocess ppp resizes in the
+    // graph just like --ppp-resize
+    if (config.inputFormat != "bgr" && (config.batchSize != 1 || config.rect || this->config.pppResize || config.tile))
+        throw std::invalid_argument("nv12/i420 input only supports single frames without rect, ppp-resize or tiling");
+
+    imgSize = config.imgSize;
 
     int width = imgSize[0];
     int height = imgSize[1];
 
     modelInputShape[3] = width;
     modelInputShape[2] = height;
+    modelInputShape[0] = config.batchSize;
+
+    PoolSet pools;
+    bool gpu = config.device.gpu;
+    if (gpu)
+        try {
+        device = "GPU";
+        pools = createPools(core, modelPath);
+    }
+        catch (const std::runtime_error& err){
+            std::cerr << LogWarning("Failed to use GPU. Using CPU instead...", err.what()) << std::endl;
+            gpu = false;
+        }
+    
+    if (!gpu) {
+        device = "CPU";
+        pools = createPools(core, modelPath);
+    }
+
+    WarmupReport report;
+    if (config.warmup > 0) {
+        report = warmup(pools);
+        std::cout << LogInfo("Warm-up", "cold=" + std::to_string(report.coldMs) + "ms warm=" + std::to_string(report.warmMs) + "ms");
+        std::cout << " (" << report.runs << " runs)" << std::endl;
+    }
+
+    infer_pools = std::make_shared<const PoolSet>(std::move(pools));
+    compiled_model = std::make_shared<ov::CompiledModel>((*infer_pools)[0]->compiledModel());
+
+    if (config.watchModel)
+        watcher = std::thread(&YoloNAS::watchModel, this);
+
+    if (config.onReady)
+        config.onReady(report);
+
+}
+
+YoloNAS::~YoloNAS()
+{
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        stopping = true;
+    }
+    reloadCv.notify_all();
+
+    if (watcher.joinable())
+        watcher.join();
+    if (reloader.joinable())
+        reloader.join();
+}
+
+YoloNAS::PoolSet YoloNAS::createPools(ov::Core& core, const std::string& modelPath)
+{
+    PoolSet pools;
+    if (device != "CPU") {
+        pools.push_back(createPool(core, modelPath, device));
+        return pools;
+    }
+
+    std::vector<NumaNode> nodes;
+    if (config.numa) {
+        nodes = numaNodes();
+        if (nodes.size() < 2)
+            std::cerr << LogWarning("NUMA", "fewer than two NUMA nodes found, using a single instance") << std::endl;
+    }
+
+    if (nodes.size() < 2) {
+        pools.push_back(createPool(core, modelPath, device));
+    }
+    else {
+        for (const auto& node : nodes)
+            pools.push_back(createNumaPool(core, modelPath, node));
+    }
+    return pools;
+}
+
+std::shared_ptr<const YoloNAS::PoolSet> YoloNAS::pools() const
+{
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    return infer_pools;
+}
+
+bool YoloNAS::reload(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(reloadMutex);
+    if (reloading || stopping) {
+        std::cerr << LogWarning("Reload", "a reload is already in progress") << std::endl;
+        return false;
+    }
+
+    // the previous reload thread has finished, only its handle is left
+    if (reloader.joinable())
+        reloader.join();
+
+    reloading = true;
+    std::string newPath = path.empty() ? modelPath : path;
+    reloader = std::thread([this, newPath]() {
+        try {
+            // compile and warm up next to the serving instances, frames keep
+            // running on the old model meanwhile
+            auto begin = std::chrono::steady_clock::now();
+            ov::Core core;
+            if (!config.cacheDir.empty())
+                core.set_property(ov::cache_dir(config.cacheDir));
+
+            PoolSet pools = createPools(core, newPath);
+            if (config.warmup > 0)
+                warmup(pools);
+            auto end = std::chrono::steady_clock::now();
+
+            // new frames go to the new instances, frames in flight hold a
+            // reference to their old pool until they are retrieved
+            {
+                std::lock_guard<std::mutex> lock(poolsMutex);
+                infer_pools = std::make_shared<const PoolSet>(std::move(pools));
+                compiled_model = std::make_shared<ov::CompiledModel>((*infer_pools)[0]->compiledModel());
+                modelPath = newPath;
+            }
+
+            float elapsed = std::chrono::duration<float, std::milli>(end - begin).count();
+            std::cout << LogInfo("Reload", "model=" + newPath + " in " + std::to_string(elapsed) + "ms") << std::endl;
+        }
+        catch (const std::exception& err) {
+            std::cerr << LogWarning("Reload failed, keeping the current model", err.what()) << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        reloading = false;
+    });
+
+    return true;
+}
+
+// Model files are polled rather than watched with inotify so the same code
+// works everywhere; a change is only picked up once the files stopped
+// changing, so a model that is still being copied is not compiled
+void YoloNAS::watchModel()
+{
+    auto stamp = [this]() {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(poolsMutex);
+            path = modelPath;
+        }
+
+        std::error_code error;
+        std::filesystem::path xml(path);
+        std::filesystem::path bin = std::filesystem::path(xml).replace_extension(".bin");
+        return std::make_pair(std::filesystem::last_write_time(xml, error), std::filesystem::last_write_time(bin, error));
+    };
+
+    auto current = stamp();
+    auto last = current;
+    std::unique_lock<std::mutex> lock(reloadMutex);
+    while (!reloadCv.wait_for(lock, std::chrono::seconds(1), [this]() { return stopping; })) {
+        lock.unlock();
+        auto next = stamp();
+        bool settled = next == last && next != current;
+        last = next;
+        if (settled && reload())
+            current = next;
+        lock.lock();
+    }
+}
+
+WarmupReport YoloNAS::warmup(const PoolSet& pools)
+{
+    WarmupReport report;
+    float warmTotal = 0.0f;
+    int warmRuns = 0;
+
+    // black frames at the shape real frames will have, so shape dependent
+    // allocations and kernel selection happen now
+    size_t batch = static_cast<size_t>(std::max(1, modelInputShape[0]));
+    ov::Shape shape = { batch, static_cast<size_t>(modelInputShape[2]), static_cast<size_t>(modelInputShape[3]), 3 };
+    std::vector<cv::Mat> planes = yuvPlanes(cv::Size(modelInputShape[3], modelInputShape[2]));
+    std::vector<std::vector<Box>> boxes(batch);
+
+    for (const auto& pool : pools) {
+        for (size_t id = 0; id < pool->size(); id++) {
+            ov::InferRequest& request = pool->request(id);
+            if (!planes.empty()) {
+                fillPlanes(request, planes.data(), planes.size());
+            }
+            else {
+                ov::Tensor input_tensor = request.get_input_tensor();
+                if (input_tensor.get_shape() != shape) {
+                    input_tensor.set_shape(shape);
+                    std::memset(input_tensor.data(), 0, input_tensor.get_byte_size());
+                }
+            }
+
+            for (int run = 0; run < config.warmup; run++) {
+                auto begin = std::chrono::steady_clock::now();
+                request.infer();
+                postprocess(request, batch, boxes.data());
+                auto end = std::chrono::steady_clock::now();
+
+                float latency = std::chrono::duration<float, std::milli>(end - begin).count();
+                if (report.runs == 0) {
+                    report.coldMs = latency;
+                }
+                else {
+                    warmTotal += latency;
+                    warmRuns++;
+                }
+                report.runs++;
+            }
+        }
+    }
+
+    report.warmMs = warmRuns > 0 ? warmTotal / warmRuns : report.coldMs;
+    return report;
+}
+
+std::shared_ptr<InferencePool> YoloNAS::createPool(ov::Core& core, const std::string& modelPath, const std::string& device, const ov::AnyMap& overrides)
+{
+    ov::CompiledModel compiled = compile(core, modelPath, device, overrides);
+
+    int numRequests = config.device.numRequests;
+    if (numRequests < 1)
+        numRequests = static_cast<int>(compiled.get_property(ov::optimal_number_of_infer_requests));
+
+    std::shared_ptr<InferencePool> pool = std::make_shared<InferencePool>(compiled, numRequests);
+
+    // touch static input tensors now, so their pages land on the node of the
+    // calling thread rather than wherever the first frame is written from
+    if (compiled.inputs().size() == 1 && compiled.input().get_partial_shape().is_static()) {
+        for (size_t id = 0; id < pool->size(); id++) {
+            ov::Tensor input_tensor = pool->request(id).get_input_tensor();
+            std::memset(input_tensor.data(), 0, input_tensor.get_byte_size());
+        }
+    }
+
+    return pool;
+}
+
+std::shared_ptr<InferencePool> YoloNAS::createNumaPool(ov::Core& core, const std::string& modelPath, const NumaNode& node)
+{
+    // threads created by the plugin inherit the affinity of the compiling
+    // thread, so the whole instance stays on the node unless the plugin is
+    // told to pin its threads elsewhere. The plugin's own pinning does not
+    // know about the node and would place every instance on the same cores.
+    ov::AnyMap overrides;
+    if (config.device.numThreads <= 0)
+        overrides.emplace(ov::inference_num_threads(static_cast<int>(node.cpus.size())));
+    if (config.device.cpuPinning < 0)
+        overrides.emplace("ENABLE_CPU_PINNING", "NO");
+
+    // On the first load the threads that appear while the instance compiles
+    // are taken to be the plugin's. A reload compiles next to the serving
+    // instances, their callback threads and the application's own, which
+    // cannot be told apart from the plugin's, so there the binding is left
+    // to inheritance and nothing is checked or moved.
+    bool verify = pools() == nullptr;
+
+    std::shared_ptr<InferencePool> pool;
+    std::exception_ptr error;
+    std::vector<int> before;
+    if (verify)
+        before = processThreads();
+    std::thread worker([&]() {
+        try {
+            if (!pinCurrentThread(node.cpus))
+                std::cerr << LogWarning("NUMA", "failed to bind to node " + std::to_string(node.id)) << std::endl;
+            pool = createPool(core, modelPath, "CPU", overrides);
+
+            // the plugin starts some of its threads lazily, run every request
+            // once from here so they are created now, with this thread's mask
+            ov::CompiledModel& compiled = pool->compiledModel();
+            if (compiled.inputs().size() == 1 && compiled.input().get_partial_shape().is_static()) {
+                for (size_t id = 0; id < pool->size(); id++)
+                    pool->request(id).infer();
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+    });
+    worker.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    std::cout << LogInfo("NUMA", "node " + std::to_string(node.id) + ": " + std::to_string(node.cpus.size()) + " CPUs, ");
+    std::cout << pool->size() << " infer requests";
+    if (!verify) {
+        std::cout << std::endl;
+        return pool;
+    }
+
+    // check that the threads this instance started really are on the node,
+    // and bind the ones that are not (the worker itself has exited)
+    size_t started = 0, moved = 0;
+    for (int tid : processThreads()) {
+        if (std::binary_search(before.begin(), before.end(), tid))
+            continue;
+        started++;
+        std::vector<int> cpus = threadCpus(tid);
+        bool onNode = !cpus.empty() && std::all_of(cpus.begin(), cpus.end(), [&node](int cpu) {
+            return std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end();
+        });
+        if (!onNode && pinThread(tid, node.cpus))
+            moved++;
+    }
+
+    std::cout << ", " << started << " inference threads";
+    if (moved > 0)
+        std::cout << " (" << moved << " re-bound)";
+    std::cout << std::endl;
+    if (started == 0)
+        std::cerr << LogWarning("NUMA", "node " + std::to_string(node.id) + " started no threads of its own and may run on threads bound to another node") << std::endl;
+
+    return pool;
+}
+
+std::shared_ptr<InferencePool> YoloNAS::nextPool()
+{
+    std::shared_ptr<const PoolSet> snapshot = pools();
+    const PoolSet& infer_pools = *snapshot;
+
+    size_t count = infer_pools.size();
+    if (count == 1)
+        return infer_pools[0];
+
+    if (config.numaDispatch == "least-load") {
+        size_t best = 0;
+        float bestLoad = 2.0f;
+        for (size_t i = 0; i < count; i++) {
+            float load = (float)infer_pools[i]->busy() / (float)infer_pools[i]->size();
+            if (load < bestLoad) {
+                best = i;
+                bestLoad = load;
+            }
+        }
+        return infer_pools[best];
+    }
+
+    // round robin, skipping instances without a free request
+    size_t start = nextInstance++;
+    for (size_t i = 0; i < count; i++) {
+        const auto& pool = infer_pools[(start + i) % count];
+        if (pool->busy() < pool->size())
+            return pool;
+    }
+    return infer_pools[start % count];
+}
+
+std::shared_ptr<ov::Model> YoloNAS::buildModel(ov::Core& core, const std::string& modelPath)
+{
+    std::shared_ptr<ov::Model> model = core.read_model(modelPath);
+
+    // batchSize = 0 leaves the batch dimension dynamic, rect mode needs a
+    // dynamic H/W to take stride-padded canvases of any aspect ratio
+    if (config.batchSize != 1 || config.rect) {
+        ov::PartialShape inputShape = model->input().get_partial_shape();
+        inputShape[0] = config.batchSize > 0 ? ov::Dimension(config.batchSize) : ov::Dimension::dynamic();
+        if (config.rect) {
+            inputShape[2] = ov::Dimension::dynamic();
+            inputShape[3] = ov::Dimension::dynamic();
+        }
+        model->reshape(inputShape);
+    }
 
     // preprocessing for the model
     ov::preprocess::PrePostProcessor ppp = ov::preprocess::PrePostProcessor(model);
     ppp.input().tensor().set_element_type(ov::element::u8).set_layout("NHWC");
+    if (config.inputFormat != "bgr") {
+        // decoder planes of any size, converted and resized inside the graph
+        ov::preprocess::ColorFormat format = config.inputFormat == "nv12" ? ov::preprocess::ColorFormat::NV12_TWO_PLANES : ov::preprocess::ColorFormat::I420_THREE_PLANES;
+        ppp.input().tensor().set_spatial_dynamic_shape().set_color_format(format);
+        ppp.input().preprocess().convert_color(ov::preprocess::ColorFormat::BGR);
+        ppp.input().preprocess().resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
+    }
+    else if (config.pppResize) {
+        // accept decoded BGR frames of any size and resize them inside the graph,
+        // the IR already expects BGR (mo --reverse_input_channels)
+        ppp.input().tensor().set_spatial_dynamic_shape().set_color_format(ov::preprocess::ColorFormat::BGR);
+        ppp.input().preprocess().resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR);
+    }
     ppp.input().preprocess().convert_element_type(ov::element::f32);
     ppp.input().model().set_layout("NCHW");
 
     // embed above steps in the graph
     model = ppp.build();
 
-    if (gpu)
+    if (!config.classes.empty())
+        model = selectClasses(model);
+
+    if (config.graphNms)
+        model = appendNms(model);
+    else if (config.graphMaxScore)
+        model = appendMaxScore(model);
+
+    return model;
+}
+
+std::shared_ptr<ov::Model> YoloNAS::appendNms(const std::shared_ptr<ov::Model>& model) const
+{
+    ov::Output<ov::Node> bboxes = model->output(0); // [N, anchors, 4]
+    ov::Output<ov::Node> scores = model->output(1); // [N, anchors, classes]
+
+    // single label: zero every score except the best class of each anchor
+    if (!config.multiLabel) {
+        auto axis = ov::opset9::Constant::create(ov::element::i64, ov::Shape{ 1 }, { -1 });
+        auto maxScores = std::make_shared<ov::opset9::ReduceMax>(scores, axis, true);
+        auto isMax = std::make_shared<ov::opset9::Equal>(scores, maxScores);
+        auto zero = ov::opset9::Constant::create(ov::element::f32, ov::Shape{}, { 0.0f });
+        scores = std::make_shared<ov::opset9::Select>(isMax, scores, zero);
+    }
+
+    // MulticlassNms expects scores as [N, classes, anchors]
+    auto order = ov::opset9::Constant::create(ov::element::i64, ov::Shape{ 3 }, { 0, 2, 1 });
+    auto scoresT = std::make_shared<ov::opset9::Transpose>(scores, order);
+
+    ov::opset9::MulticlassNms::Attributes attrs;
+    attrs.sort_result_type = ov::opset9::MulticlassNms::SortResultType::SCORE;
+    attrs.sort_result_across_batch = false;
+    attrs.output_type = ov::element::i32;
+    attrs.iou_threshold = config.iouThresh;
+    attrs.score_threshold = config.scoreThresh;
+    attrs.nms_top_k = config.nmsTopK;
+    attrs.keep_top_k = config.maxPredictions;
+    attrs.background_class = -1;
+    // "normalized" only drops the +1 pixel convention from the IoU, which
+    // matches performNMS for our pixel coordinates
+    attrs.normalized = true;
+    auto nms = std::make_shared<ov::opset9::MulticlassNms>(bboxes, scoresT, attrs);
+
+    // [K, 6] detections (class, score, x1, y1, x2, y2) and [N] detections per image
+    ov::Output<ov::Node> detections = nms->output(0);
+    ov::Output<ov::Node> counts = nms->output(2);
+    detections.set_names({ "detections" });
+    counts.set_names({ "detections_per_image" });
+
+    return std::make_shared<ov::Model>(ov::OutputVector{ detections, counts }, model->get_parameters(), "yolo_nas_nms");
+}
+
+std::shared_ptr<ov::Model> YoloNAS::selectClasses(const std::shared_ptr<ov::Model>& model) const
+{
+    ov::Output<ov::Node> bboxes = model->output(0); // [N, anchors, 4]
+    ov::Output<ov::Node> scores = model->output(1); // [N, anchors, classes]
+
+    // the Gather would read past the score channels otherwise
+    const ov::Dimension& classes = scores.get_partial_shape()[2];
+    for (int id : config.classes) {
+        if (classes.is_static() && id >= classes.get_length())
+            throw std::invalid_argument("class id " + std::to_string(id) + " is not below the model's " + std::to_string(classes.get_length()) + " classes");
+    }
+
+    // [N, anchors, allowed classes], channel i is class config.classes[i]
+    std::vector<int64_t> indices(config.classes.begin(), config.classes.end());
+    auto channels = ov::opset9::Constant::create(ov::element::i64, ov::Shape{ indices.size() }, indices);
+    auto axis = ov::opset9::Constant::create(ov::element::i64, ov::Shape{}, { 2 });
+    ov::Output<ov::Node> selected = std::make_shared<ov::opset9::Gather>(scores, channels, axis);
+    selected.set_names({ "selected_scores" });
+
+    return std::make_shared<ov::Model>(ov::OutputVector{ bboxes, selected }, model->get_parameters(), "yolo_nas_classes");
+}
+
+std::shared_ptr<ov::Model> YoloNAS::appendMaxScore(const std::shared_ptr<ov::Model>& model) const
+{
+    ov::Output<ov::Node> bboxes = model->output(0); // [N, anchors, 4]
+    ov::Output<ov::Node> scores = model->output(1); // [N, anchors, classes]
+
+    // TopK with k = 1 gives the best score of every anchor and its class at once
+    auto one = ov::opset9::Constant::create(ov::element::i64, ov::Shape{}, { 1 });
+    auto best = std::make_shared<ov::opset9::TopK>(scores, one, -1, ov::opset9::TopK::Mode::MAX, ov::opset9::TopK::SortType::NONE, ov::element::i32);
+    ov::Output<ov::Node> bestScores = best->output(0); // [N, anchors, 1]
+    ov::Output<ov::Node> bestClasses = std::make_shared<ov::opset9::Convert>(best->output(1), ov::element::f32);
+
+    if (config.graphTopK > 0) {
+        // only the best anchors leave the graph, all of them when a (rect)
+        // frame has fewer than graphTopK
+        auto axis = ov::opset9::Constant::create(ov::element::i64, ov::Shape{}, { 1 });
+        auto shape = std::make_shared<ov::opset9::ShapeOf>(scores, ov::element::i64);
+        auto anchors = std::make_shared<ov::opset9::Gather>(shape, axis, ov::opset9::Constant::create(ov::element::i64, ov::Shape{}, { 0 }));
+        auto k = std::make_shared<ov::opset9::Minimum>(anchors, ov::opset9::Constant::create(ov::element::i64, ov::Shape{}, { config.graphTopK }));
+
+        auto lastAxis = ov::opset9::Constant::create(ov::element::i64, ov::Shape{ 1 }, { 2 });
+        auto anchorScores = std::make_shared<ov::opset9::Squeeze>(bestScores, lastAxis); // [N, anchors]
+        auto top = std::make_shared<ov::opset9::TopK>(anchorScores, k, 1, ov::opset9::TopK::Mode::MAX, ov::opset9::TopK::SortType::SORT_VALUES, ov::element::i32);
+
+        // [N, K] anchor indices pick the boxes and classes of every image
+        ov::Output<ov::Node> indices = top->output(1);
+        bboxes = std::make_shared<ov::opset9::Gather>(bboxes, indices, axis, 1);
+        bestScores = std::make_shared<ov::opset9::Gather>(bestScores, indices, axis, 1);
+        bestClasses = std::make_shared<ov::opset9::Gather>(bestClasses, indices, axis, 1);
+        bboxes.set_names({ "top_bboxes" });
+    }
+
+    // [N, rows, 2] (score, class) pairs, read instead of [N, anchors, classes]
+    ov::Output<ov::Node> pairs = std::make_shared<ov::opset9::Concat>(ov::OutputVector{ bestScores, bestClasses }, -1);
+    pairs.set_names({ "best_scores" });
+
+    return std::make_shared<ov::Model>(ov::OutputVector{ bboxes, pairs }, model->get_parameters(), "yolo_nas_max_score");
+}
+
+ov::CompiledModel YoloNAS::compile(ov::Core& core, const std::string& modelPath, const std::string& device, const ov::AnyMap& overrides)
+{
+    ov::AnyMap properties = compileProperties(config.device, device == "CPU");
+    for (const auto& property : overrides)
+        properties[property.first] = property.second;
+    if (!config.compiledBlob)
+        return core.compile_model(buildModel(core, modelPath), device, properties);
+
+    std::filesystem::path blobPath = compiledBlobPath(modelPath, device, properties);
+    {
+        std::ifstream blob(blobPath, std::ios::binary);
+        if (blob.is_open()) {
+            try {
+                ov::CompiledModel compiled = core.import_model(blob, device, properties);
+                std::cout << LogInfo("Compiled Blob", "imported " + blobPath.string()) << std::endl;
+                return compiled;
+            }
+            catch (const ov::Exception& err) {
+                std::cerr << LogWarning("Failed to import compiled blob. Recompiling...", err.what()) << std::endl;
+            }
+        }
+    }
+
+    ov::CompiledModel compiled = core.compile_model(buildModel(core, modelPath), device, properties);
+
+    // write next to the final name and rename, so workers starting at the
+    // same time never import a half written blob
+    std::filesystem::create_directories(blobPath.parent_path());
+    std::filesystem::path tmpPath = blobPath;
+    tmpPath += "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        compiled.export_model(out);
+    }
+    std::error_code error;
+    std::filesystem::rename(tmpPath, blobPath, error);
+    if (error) {
+        std::cerr << LogWarning("Failed to export compiled blob", error.message()) << std::endl;
+        std::filesystem::remove(tmpPath, error);
+    }
+    else {
+        std::cout << LogInfo("Compiled Blob", "exported " + blobPath.string()) << std::endl;
+    }
+
+    return compiled;
+}
+
+std::filesystem::path YoloNAS::compiledBlobPath(const std::string& modelPath, const std::string& device, const ov::AnyMap& properties) const
+{
+    // a blob is only valid for the same weights, graph options, device,
+    // compile properties and runtime build
+    uint64_t hash = modelFilesHash(modelPath);
+
+    std::string key = "imgsz=" + std::to_string(modelInputShape[3]) + "x" + std::to_string(modelInputShape[2]);
+    key += ";batch=" + std::to_string(config.batchSize);
+    key += ";ppp-resize=" + std::to_string(config.pppResize);
+    key += ";input-format=" + config.inputFormat;
+    key += ";rect=" + std::to_string(config.rect);
+    if (!config.classes.empty()) {
+        key += ";classes=";
+        for (int id : config.classes)
+            key += std::to_string(id) + ",";
+    }
+    if (config.graphNms) {
+        key += ";graph-nms=" + std::to_string(config.scoreThresh) + "," + std::to_string(config.iouThresh);
+        key += "," + std::to_string(config.nmsTopK) + "," + std::to_string(config.maxPredictions) + "," + std::to_string(config.multiLabel);
+    }
+    else if (config.graphMaxScore) {
+        key += ";graph-max-score=" + std::to_string(config.graphTopK);
+    }
+    key += ";device=" + device;
+    for (const auto& property : properties)
+        key += ";" + property.first + "=" + property.second.as<std::string>();
+    key += ";openvino=" + std::string(ov::get_openvino_version().buildNumber);
+    hash = hashString(key, hash);
+
+    std::ostringstream name;
+    name << "yolo-nas-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".blob";
+
+    std::filesystem::path cacheDir = config.cacheDir.empty() ? std::filesystem::path(".") : std::filesystem::path(config.cacheDir);
+    return cacheDir / name.str();
+}
+
+uint64_t YoloNAS::modelFilesHash(const std::string& modelPath) const
+{
+    std::filesystem::path weightsPath = std::filesystem::path(modelPath).replace_extension(".bin");
+    bool weights = std::filesystem::exists(weightsPath);
+
+    auto fileStamp = [](const std::filesystem::path& path) {
+        std::error_code error;
+        return ";" + std::to_string(std::filesystem::file_size(path, error)) + ","
+            + std::to_string(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    };
+    std::string stamp = modelPath + fileStamp(modelPath);
+    if (weights)
+        stamp += fileStamp(weightsPath);
+
+    std::lock_guard<std::mutex> lock(modelHashMutex);
+    if (stamp != modelHashStamp) {
+        modelHash = hashFile(modelPath);
+        if (weights)
+            modelHash = hashFile(weightsPath.string(), modelHash);
+        modelHashStamp = stamp;
+    }
+    return modelHash;
+}
+
+std::shared_ptr<ov::CompiledModel> YoloNAS::compiledModel() const
+{
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    return compiled_model;
+}
+
+void YoloNAS::printProperties() const
+{
+    std::shared_ptr<ov::CompiledModel> compiled_model = compiledModel();
+
+    std::cout << LogInfo("Compiled Model", "device=" + device) << std::endl;
+
+    for (const auto& name : compiled_model->get_property(ov::supported_properties)) {
+        if (name == ov::supported_properties.name())
+            continue;
+
         try {
-        compiled_model = std::make_shared<ov::CompiledModel>(core.compile_model(model, "GPU"));
+            std::cout << "    " << name << ": " << compiled_model->get_property(name).as<std::string>() << std::endl;
+        }
+        catch (const ov::Exception&) {
+            // some properties are listed but not readable on every device
+        }
     }
-        catch (const std::runtime_error& err){
-            std::cerr << LogWarning("Failed to use GPU. Using CPU instead...", err.what()) << std::endl;
-            gpu = false;
+}
+
+cv::Size YoloNAS::rectShape(const cv::Mat& source) const
+{
+    // fit the image into imgsz, then pad each side only up to the model stride
+    float scale = std::min((float)modelInputShape[3] / (float)source.cols, (float)modelInputShape[2] / (float)source.rows);
+    int width = cvRound(source.cols * scale);
+    int height = cvRound(source.rows * scale);
+    return cv::Size((width + modelStride - 1) / modelStride * modelStride, (height + modelStride - 1) / modelStride * modelStride);
+}
+
+cv::Size YoloNAS::decodeSize(cv::Size image) const
+{
+    int width = modelInputShape[3];
+    int height = modelInputShape[2];
+
+    // tiles are cut from the full resolution image
+    if (config.tile)
+        return image;
+    if (config.pppResize)
+        return cv::Size(width, height);
+
+    // size of the scaled image inside the letterbox
+    float xScale, yScale;
+    if (config.rect) {
+        xScale = yScale = std::min((float)width / (float)image.width, (float)height / (float)image.height);
+    }
+    else {
+        int maxSize = std::max(image.width, image.height);
+        xScale = (float)width / (float)maxSize;
+        yScale = (float)height / (float)maxSize;
+    }
+    return cv::Size((int)std::ceil(image.width * xScale), (int)std::ceil(image.height * yScale));
+}
+
+cv::Mat YoloNAS::readImage(const std::string& path, Ratios& ratios)
+{
+    int factor = 1;
+    cv::Size size = config.reducedDecode ? jpegSize(path) : cv::Size();
+    if (!size.empty()) {
+        // EXIF orientation may swap the sides after decoding, so the factor
+        // has to suit both orientations
+        cv::Size rotated(size.height, size.width);
+        factor = std::min(reducedDecodeFactor(size, decodeSize(size)), reducedDecodeFactor(rotated, decodeSize(rotated)));
+    }
+
+    cv::Mat img = cv::imread(path, reducedReadFlag(factor));
+    ratios = { 1.0f, 1.0f };
+    if (img.empty() || factor == 1)
+        return img;
+
+    if ((img.cols > img.rows) != (size.width > size.height))
+        std::swap(size.width, size.height);
+    ratios = { (float)size.width / (float)img.cols, (float)size.height / (float)img.rows };
+    return img;
+}
+
+void YoloNAS::letterbox(const cv::Mat& source, cv::Mat& dst, Ratios& ratios)
+{
+    float xRatio, yRatio;
+    if (config.rect) {
+        // keep the aspect ratio, the canvas is only as large as needed
+        float scale = std::min((float)modelInputShape[3] / (float)source.cols, (float)modelInputShape[2] / (float)source.rows);
+        xRatio = yRatio = 1.0f / scale;
+    }
+    else {
+        // the image is scaled as if padded to [n x n] dim
+        int maxSize = std::max(source.cols, source.rows);
+        xRatio = (float)maxSize / (float)modelInputShape[3];
+        yRatio = (float)maxSize / (float)modelInputShape[2];
+    }
+
+    // dst usually already points at the input tensor
+    if (dst.empty())
+        dst.create(config.rect ? rectShape(source) : cv::Size(modelInputShape[3], modelInputShape[2]), CV_8UC3);
+
+    // resize straight into the top-left corner, the rest of dst is the padding
+    int width = std::max(1, std::min(dst.cols, cvRound(source.cols / xRatio)));
+    int height = std::max(1, std::min(dst.rows, cvRound(source.rows / yRatio)));
+    preprocessor->resize(source, dst, cv::Size(width, height));
+
+    ratios = { xRatio, yRatio };
+}
+
+void YoloNAS::fillInput(ov::InferRequest& request, const cv::Mat* images, size_t count, Ratios* ratios)
+{
+    if (config.inputFormat != "bgr")
+        throw std::invalid_argument("the model was built for " + config.inputFormat + " input, use detectNV12() or detectI420()");
+
+    if (config.pppResize) {
+        fillRawInput(request, images, count, ratios);
+        return;
+    }
+
+    size_t width = static_cast<size_t>(modelInputShape[3]);
+    size_t height = static_cast<size_t>(modelInputShape[2]);
+
+    // rectangular canvases must hold every image of the batch
+    if (config.rect) {
+        width = height = 0;
+        for (size_t i = 0; i < count; i++) {
+            cv::Size shape = rectShape(images[i]);
+            width = std::max(width, static_cast<size_t>(shape.width));
+            height = std::max(height, static_cast<size_t>(shape.height));
         }
-    
-    if (!gpu) {
-        compiled_model = std::make_shared<ov::CompiledModel>(core.compile_model(model, "CPU"));
     }
 
-    infer_request = std::make_shared<ov::InferRequest>(compiled_model -> create_infer_request());
+    // a dynamic batch is sized to the images, a static one is always filled completely
+    ov::Tensor input_tensor = request.get_input_tensor();
+    size_t batch = modelInputShape[0] > 0 ? static_cast<size_t>(modelInputShape[0]) : count;
+    if (modelInputShape[0] < 1 || config.rect)
+        input_tensor.set_shape({ batch, height, width, 3 });
+
+    uint8_t* input_data = input_tensor.data<uint8_t>();
+
+    for (size_t i = 0; i < batch; i++) {
+        // header over the request's own NHWC memory, letterbox writes into it in place
+        cv::Mat dst(static_cast<int>(height), static_cast<int>(width), CV_8UC3, input_data + i * height * width * 3);
+        if (i < count)
+            letterbox(images[i], dst, ratios[i]);
+        else
+            dst.setTo(cv::Scalar::all(0));
+    }
+}
+
+void YoloNAS::fillRawInput(ov::InferRequest& request, const cv::Mat* images, size_t count, Ratios* ratios)
+{
+    size_t batch = modelInputShape[0] > 0 ? static_cast<size_t>(modelInputShape[0]) : count;
+    size_t rows = static_cast<size_t>(images[0].rows);
+    size_t cols = static_cast<size_t>(images[0].cols);
+
+    // the graph stretches every image to the model size
+    for (size_t i = 0; i < count; i++)
+        ratios[i] = { (float)images[i].cols / (float)modelInputShape[3], (float)images[i].rows / (float)modelInputShape[2] };
+
+    // a single decoded frame is handed over as is
+    if (batch == 1 && images[0].isContinuous()) {
+        request.set_input_tensor(ov::Tensor(ov::element::u8, { 1, rows, cols, 3 }, images[0].data));
+        return;
+    }
+
+    // a batch shares one spatial shape, so images are copied (and resized to
+    // the first image's size when they differ) into a fresh tensor
+    ov::Tensor input_tensor(ov::element::u8, { batch, rows, cols, 3 });
+    uint8_t* input_data = input_tensor.data<uint8_t>();
+
+    for (size_t i = 0; i < batch; i++) {
+        cv::Mat dst(static_cast<int>(rows), static_cast<int>(cols), CV_8UC3, input_data + i * rows * cols * 3);
+        if (i >= count)
+            dst.setTo(cv::Scalar::all(0));
+        else if (images[i].size() == dst.size())
+            images[i].copyTo(dst);
+        else
+            cv::resize(images[i], dst, dst.size(), 0, 0, cv::INTER_LINEAR);
+    }
+
+    request.set_input_tensor(input_tensor);
+}
+
+std::vector<cv::Mat> YoloNAS::yuvPlanes(cv::Size size) const
+{
+    // chroma planes are subsampled 2x in both directions
+    cv::Size chroma(size.width / 2, size.height / 2);
+    if (config.inputFormat == "nv12")
+        return { cv::Mat::zeros(size, CV_8UC1), cv::Mat::zeros(chroma, CV_8UC2) };
+    if (config.inputFormat == "i420")
+        return { cv::Mat::zeros(size, CV_8UC1), cv::Mat::zeros(chroma, CV_8UC1), cv::Mat::zeros(chroma, CV_8UC1) };
+    return {};
+}
+
+void YoloNAS::fillPlanes(ov::InferRequest& request, const cv::Mat* planes, size_t count)
+{
+    size_t expected = config.inputFormat == "nv12" ? 2 : 3;
+    if (config.inputFormat == "bgr" || count != expected)
+        throw std::invalid_argument("expected " + std::to_string(expected) + " planes for " + config.inputFormat + " input");
+
+    // one tensor per plane over the caller's memory, the graph does the rest
+    for (size_t i = 0; i < count; i++) {
+        if (!planes[i].isContinuous())
+            throw std::invalid_argument("YUV planes must be continuous");
+        ov::Shape shape = { 1, static_cast<size_t>(planes[i].rows), static_cast<size_t>(planes[i].cols), static_cast<size_t>(planes[i].channels()) };
+        request.set_input_tensor(i, ov::Tensor(ov::element::u8, shape, planes[i].data));
+    }
+}
+
+std::vector<Box> YoloNAS::detectPlanes(const cv::Mat* planes, size_t count)
+{
+    std::shared_ptr<InferencePool> pool = nextPool();
+    size_t id = pool->acquire();
+
+    std::vector<Box> boxes;
+    try {
+        fillPlanes(pool->request(id), planes, count);
+        pool->start(id);
+        pool->wait(id);
+        postprocess(pool->request(id), 1, &boxes);
+    }
+    catch (...) {
+        pool->release(id);
+        throw;
+    }
+    pool->release(id);
+
+    // the graph stretches the frame to the model size
+    Ratios ratios = { (float)planes[0].cols / (float)modelInputShape[3], (float)planes[0].rows / (float)modelInputShape[2] };
+    scaleBoxes(boxes, ratios);
+    return boxes;
+}
+
+std::vector<Box> YoloNAS::detectNV12(const cv::Mat& y, const cv::Mat& uv)
+{
+    cv::Mat planes[] = { y, uv };
+    return detectPlanes(planes, 2);
+}
+
+std::vector<Box> YoloNAS::detectI420(const cv::Mat& y, const cv::Mat& u, const cv::Mat& v)
+{
+    cv::Mat planes[] = { y, u, v };
+    return detectPlanes(planes, 3);
+}
+
+std::unique_ptr<PPYoloEPostPredictionCallback> YoloNAS::takePostprocessor()
+{
+    std::lock_guard<std::mutex> lock(postprocessorsMutex);
+    if (idlePostprocessors.empty())
+        return std::make_unique<PPYoloEPostPredictionCallback>(postprocessor);
+
+    std::unique_ptr<PPYoloEPostPredictionCallback> callback = std::move(idlePostprocessors.back());
+    idlePostprocessors.pop_back();
+    return callback;
+}
+
+void YoloNAS::returnPostprocessor(std::unique_ptr<PPYoloEPostPredictionCallback> callback)
+{
+    std::lock_guard<std::mutex> lock(postprocessorsMutex);
+    idlePostprocessors.push_back(std::move(callback));
+}
+
+void YoloNAS::postprocess(ov::InferRequest& request, size_t count, std::vector<Box>* results)
+{
+    if (config.graphNms) {
+        // the graph already filtered and suppressed, only copy the survivors out
+        const ov::Tensor& output_tensor_detections = request.get_output_tensor(0);
+        const ov::Tensor& output_tensor_counts = request.get_output_tensor(1);
+        postprocessor.forwardNms(output_tensor_detections.data<float>(), output_tensor_counts.data<int32_t>(), results, count);
+        return;
+    }
+
+    // Retrieve inference results - bboxes [N, anchors, 4] and scores [N, anchors, classes],
+    // or [N, rows, 2] (score, class) pairs of the best anchors with graphMaxScore
+    const ov::Tensor& output_tensor_bboxes = request.get_output_tensor(0);
+    const ov::Tensor& output_tensor_scores = request.get_output_tensor(1);
+
+    // dimensions from the element counts, get_shape() returns a new ov::Shape
+    // every call; a static batch holds padding images after the first count
+    size_t batch = modelInputShape[0] > 0 ? static_cast<size_t>(modelInputShape[0]) : count;
+    size_t anchors = output_tensor_bboxes.get_size() / (batch * 4);
+    size_t classes = output_tensor_scores.get_size() / (batch * anchors);
 
+    // Postprocess predictions with a postprocessor no other thread is using
+    std::unique_ptr<PPYoloEPostPredictionCallback> callback = takePostprocessor();
+    if (config.graphMaxScore)
+        callback->forwardBest(output_tensor_bboxes.data<float>(), output_tensor_scores.data<float>(), anchors, results, count);
+    else
+        callback->forward(output_tensor_bboxes.data<float>(), output_tensor_scores.data<float>(), anchors, classes, results, count);
+    returnPostprocessor(std::move(callback));
 }
 
-void YoloNAS::letterbox(cv::Mat& source, cv::Mat& dst, std::vector<float>& ratios)
+void YoloNAS::scaleBoxes(std::vector<Box>& boxes, const Ratios& ratios)
 {
-    // padding image to [n x n] dim
-    int maxSize = std::max(source.cols, source.rows);
-    int xPad = maxSize - source.cols;
-    int yPad = maxSize - source.rows;
-    float xRatio = (float)maxSize / (float)modelInputShape[3];
-    float yRatio = (float)maxSize / (float)modelInputShape[2];
+    for (auto& box : boxes) {
+        box.x1 *= ratios[0];
+        box.y1 *= ratios[1];
+        box.x2 *= ratios[0];
+        box.y2 *= ratios[1];
+    }
+}
+
+void YoloNAS::detectBatch(const cv::Mat* images, size_t count, std::vector<Box>* results)
+{
+    if (count == 0)
+        return;
+    size_t capacity = modelInputShape[0] > 0 ? static_cast<size_t>(modelInputShape[0]) : count;
+    size_t chunkCount = (count + capacity - 1) / capacity;
 
-    cv::copyMakeBorder(source, dst, 0, yPad, 0, xPad, cv::BORDER_CONSTANT); // padding black
+    struct Chunk
+    {
+        std::shared_ptr<InferencePool> pool;
+        size_t request;
+        size_t begin;
+        size_t count;
+    };
 
-    cv::resize(dst, dst, cv::Size(modelInputShape[3], modelInputShape[2]), 0, 0, cv::INTER_NEAREST);
+    // ratios of every image and the chunks in submission order, on the stack
+    // unless a call brings more than a few images, so a single frame never
+    // touches the heap
+    constexpr size_t inlineImages = 8;
+    std::array<Ratios, inlineImages> inlineRatios;
+    std::array<Chunk, inlineImages> inlineChunks;
+    std::vector<Ratios> heapRatios;
+    std::vector<Chunk> heapChunks;
+    Ratios* ratios = inlineRatios.data();
+    Chunk* chunks = inlineChunks.data();
+    if (count > inlineImages) {
+        heapRatios.resize(count);
+        ratios = heapRatios.data();
+    }
+    if (chunkCount > inlineImages) {
+        heapChunks.resize(chunkCount);
+        chunks = heapChunks.data();
+    }
+    // chunks [finished, started) are in flight
+    size_t finished = 0;
+    size_t started = 0;
 
-    ratios.push_back(xRatio);
-    ratios.push_back(yRatio);
+    auto finish = [&]() {
+        Chunk& chunk = chunks[finished++];
+
+        try {
+            chunk.pool->wait(chunk.request);
+            postprocess(chunk.pool->request(chunk.request), chunk.count, results + chunk.begin);
+        }
+        catch (...) {
+            chunk.pool->release(chunk.request);
+            throw;
+        }
+        chunk.pool->release(chunk.request);
+
+        for (size_t i = chunk.begin; i < chunk.begin + chunk.count; i++)
+            scaleBoxes(results[i], ratios[i]);
+    };
+
+    // chunks of the compiled batch size run on as many requests as are free
+    try {
+        for (size_t begin = 0; begin < count; begin += capacity) {
+            Chunk& chunk = chunks[started];
+            chunk.begin = begin;
+            chunk.count = std::min(capacity, count - begin);
+
+            // never block on a pool while holding requests of our own
+            while (true) {
+                chunk.pool = nextPool();
+                if (chunk.pool->tryAcquire(chunk.request))
+                    break;
+                if (finished == started) {
+                    chunk.request = chunk.pool->acquire();
+                    break;
+                }
+                finish();
+            }
+
+            try {
+                fillInput(chunk.pool->request(chunk.request), images + begin, chunk.count, ratios + begin);
+                chunk.pool->start(chunk.request);
+            }
+            catch (...) {
+                chunk.pool->release(chunk.request);
+                throw;
+            }
+            started++;
+        }
+
+        while (finished < started)
+            finish();
+    }
+    catch (...) {
+        // hand the remaining requests back before giving up
+        for (; finished < started; finished++) {
+            Chunk& chunk = chunks[finished];
+            try {
+                chunk.pool->wait(chunk.request);
+            }
+            catch (...) {
+            }
+            chunk.pool->release(chunk.request);
+        }
+        throw;
+    }
+}
+
+// Tile origins along one axis, the last tile is aligned to the image border
+static std::vector<int> tileOrigins(int length, int tile, int step)
+{
+    std::vector<int> origins{ 0 };
+    while (origins.back() + tile < length)
+        origins.push_back(std::min(origins.back() + step, length - tile));
+    return origins;
+}
+
+std::vector<Box> YoloNAS::detectTiled(const cv::Mat& img)
+{
+    int tileWidth = modelInputShape[3];
+    int tileHeight = modelInputShape[2];
+    int stepX = std::max(1, cvRound(tileWidth * (1.0f - config.tileOverlap)));
+    int stepY = std::max(1, cvRound(tileHeight * (1.0f - config.tileOverlap)));
+
+    // the whole image goes first so objects larger than a tile are still found
+    std::vector<cv::Mat> tiles{ img };
+    std::vector<cv::Point> offsets{ cv::Point(0, 0) };
+    if (img.cols > tileWidth || img.rows > tileHeight) {
+        for (int y : tileOrigins(img.rows, tileHeight, stepY)) {
+            for (int x : tileOrigins(img.cols, tileWidth, stepX)) {
+                tiles.push_back(img(cv::Rect(x, y, std::min(tileWidth, img.cols - x), std::min(tileHeight, img.rows - y))));
+                offsets.push_back(cv::Point(x, y));
+            }
+        }
+    }
+
+    std::vector<std::vector<Box>> results(tiles.size());
+    detectBatch(tiles.data(), tiles.size(), results.data());
+
+    // move tile-local boxes into image coordinates and merge duplicates across tiles
+    std::vector<Box> boxes;
+    for (size_t i = 0; i < results.size(); i++) {
+        for (auto box : results[i]) {
+            box.x1 += offsets[i].x;
+            box.y1 += offsets[i].y;
+            box.x2 += offsets[i].x;
+            box.y2 += offsets[i].y;
+            boxes.push_back(box);
+        }
+    }
+
+    std::unique_ptr<PPYoloEPostPredictionCallback> callback = takePostprocessor();
+    std::vector<Box> merged = callback->merge(std::move(boxes));
+    returnPostprocessor(std::move(callback));
+    return merged;
+}
+
+std::vector<Box> YoloNAS::detect(const cv::Mat& img)
+{
+    std::vector<Box> boxes;
+    detect(img, boxes);
+    return boxes;
+}
+
+void YoloNAS::detect(const cv::Mat& img, std::vector<Box>& boxes)
+{
+    if (config.tile) {
+        boxes = detectTiled(img);
+        return;
+    }
+
+    detectBatch(&img, 1, &boxes);
+}
+
+std::vector<std::vector<Box>> YoloNAS::detect(const std::vector<cv::Mat>& imgs)
+{
+    if (config.tile) {
+        std::vector<std::vector<Box>> results;
+        for (const auto& img : imgs)
+            results.push_back(detectTiled(img));
+        return results;
+    }
+
+    std::vector<std::vector<Box>> results(imgs.size());
+    detectBatch(imgs.data(), imgs.size(), results.data());
+    return results;
 }
 
 void YoloNAS::predict(cv::Mat& img)
 {
-    cv::Mat imgInput;
-    std::vector<float> ratios;
-    letterbox(img, imgInput, ratios);
+    // reused across frames; per thread since predict() may run on several
+    thread_local std::vector<Box> boxes;
+    detect(img, boxes);
+    drawBoxes(img, boxes, 1.0f, 1.0f);
+}
+
+void YoloNAS::predict(std::vector<cv::Mat>& imgs)
+{
+    std::vector<std::vector<Box>> results = detect(imgs);
+    for (size_t i = 0; i < imgs.size(); i++)
+        drawBoxes(imgs[i], results[i], 1.0f, 1.0f);
+}
 
-    // Create tensor from image
-    float* input_data = (float*)imgInput.data;
-    ov::Tensor input_tensor = ov::Tensor(compiled_model->input().get_element_type(), compiled_model->input().get_shape(), input_data);
+void YoloNAS::submit(cv::Mat& img)
+{
+    // ring buffer, only grows when more frames are pending than ever before,
+    // and before a request is taken so a failure leaks nothing
+    if (pendingCount == pendingFrames.size()) {
+        std::vector<PendingFrame> grown(std::max(pendingFrames.size() * 2, numRequests()));
+        for (size_t i = 0; i < pendingCount; i++)
+            grown[i] = std::move(pendingFrames[(pendingHead + i) % pendingFrames.size()]);
+        pendingFrames = std::move(grown);
+        pendingHead = 0;
+    }
 
-    // Create an infer request for model inference 
-    infer_request->set_input_tensor(input_tensor);
-    infer_request->infer();
+    PendingFrame frame;
+    frame.image = img;
 
-    // Retrieve inference results - bboxes 
-    const ov::Tensor& output_tensor_bboxes = infer_request->get_output_tensor(0);
-    ov::Shape output_shape_bboxes = output_tensor_bboxes.get_shape();
-    float* bboxes = output_tensor_bboxes.data<float>();
+    frame.pool = nextPool();
+    frame.request = frame.pool->acquire();
+    try {
+        fillInput(frame.pool->request(frame.request), &img, 1, &frame.ratios);
+        frame.pool->start(frame.request);
+    }
+    catch (...) {
+        frame.pool->release(frame.request);
+        throw;
+    }
 
-    // Retrieve inference results - scores 
-    const ov::Tensor& output_tensor_scores = infer_request->get_output_tensor(1);
-    ov::Shape output_shape_scores = output_tensor_scores.get_shape();
-    float* scores = output_tensor_scores.data<float>();
+    pendingFrames[(pendingHead + pendingCount) % pendingFrames.size()] = std::move(frame);
+    pendingCount++;
+}
 
-    // Postprocess predictions
-    std::vector<std::vector<Box>> results = postprocessor.forward(bboxes, scores, output_shape_bboxes, output_shape_scores);
+bool YoloNAS::retrieve(cv::Mat& img)
+{
+    if (!retrieve(img, retrievedBoxes))
+        return false;
 
-    drawBoxes(img, results, ratios[0], ratios[1]);
+    drawBoxes(img, retrievedBoxes, 1.0f, 1.0f);
+    return true;
 }
+
+bool YoloNAS::retrieve(cv::Mat& img, std::vector<Box>& boxes)
+{
+    if (pendingCount == 0)
+        return false;
+
+    PendingFrame frame = std::move(pendingFrames[pendingHead]);
+    pendingHead = (pendingHead + 1) % pendingFrames.size();
+    pendingCount--;
+
+    try {
+        frame.pool->wait(frame.request);
+        postprocess(frame.pool->request(frame.request), 1, &boxes);
+    }
+    catch (...) {
+        frame.pool->release(frame.request);
+        throw;
+    }
+    frame.pool->release(frame.request);
+
+    scaleBoxes(boxes, frame.ratios);
+    img = frame.image;
+    return true;
+}
+
+size_t YoloNAS::pending() const
+{
+    return pendingCount;
+}
+
+size_t YoloNAS::numRequests() const
+{
+    // keep the set alive for the loop, a reload may replace it meanwhile
+    std::shared_ptr<const PoolSet> snapshot = pools();
+    size_t count = 0;
+    for (const auto& pool : *snapshot)
+        count += pool->size();
+    return count;
+}
\ No newline at end of file